@@ -0,0 +1,2 @@
+# Compile the headless application (renders to files and streams only, no window) without SFML, e.g. on a Linux server
+g++ -std=c++17 -O2 -o build/application_headless src/main.cpp -DWIREFRAME_HEADLESS -fopenmp -pthread
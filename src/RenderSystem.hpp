@@ -1,6 +1,5 @@
 #pragma once
 
-#include <SFML/Graphics.hpp>
 #include "../libs/glm/glm.hpp"
 #include "camera.h"
 #include <string>
@@ -9,276 +8,1106 @@
 #include <stdexcept> 
 #include <cmath> 
 #include <omp.h>
+#include <cstdint>
+#include <algorithm>
 #include "mesh.hpp"
+#include "framebuffer.hpp"
+#include "meshlets.hpp"
 
-glm::vec2 LineLineIntersection(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4)
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define WIREFRAME_AVX2 1
+    #include <immintrin.h>
+#endif
+
+// SUB-PIXEL PRECISION OF THE INTEGER LINE KERNEL (16 FRACTIONAL BITS)
+const int LINE_SUBPIXEL_BITS = 16;
+
+// GUARD BAND: LINES WITH BOTH END POINTS WITHIN THIS MANY PIXELS OF THE VIEWPORT ARE NOT CLIPPED,
+// THE RASTERIZER SKIPS THEIR OFF SCREEN PIXELS INSTEAD. THE WHOLE BAND MUST SPAN LESS THAN
+// LINE_MAX_EXTENT PIXELS SO THE SQUARED STEP COUNTS STAY WITHIN 64 BITS AT 16 SUB-PIXEL BITS.
+const int LINE_GUARD_BAND = 4096;
+const int LINE_MAX_EXTENT = 16384;
+
+// GUARD BAND WIDTH IN PIXELS FOR AN IMAGE OF THE GIVEN SIZE (0 = CLIP EVERYTHING TO THE VIEWPORT)
+int GuardBandPixels(int imageWidth, int imageHeight)
 {
-    glm::vec2 intersection = {-1.0f, -1.0f};
+    return std::max(0, std::min(LINE_GUARD_BAND, (LINE_MAX_EXTENT - std::max(imageWidth, imageHeight)) / 2 - 1));
+}
 
-    // CALCULATE THE LINE DIRECTIONS
-    float uA = ((x4-x3)*(y1-y3) - (y4-y3)*(x1-x3)) / ((y4-y3)*(x2-x1) - (x4-x3)*(y2-y1));
-    float uB = ((x2-x1)*(y1-y3) - (y2-y1)*(x1-x3)) / ((y4-y3)*(x2-x1) - (x4-x3)*(y2-y1));
+// LINE READY FOR RASTERIZATION. THE KERNEL IS THE ORIGINAL FLOAT BRESENHAM (FRACTIONAL START AND
+// DELTAS, STOP ONCE THE DISTANCE TRAVELLED REACHES THE LINE LENGTH) IN FIXED POINT. ITS STEPPING HAS
+// A CLOSED FORM: THE MAJOR AXIS ADVANCES EVERY PIXEL AND AFTER N PIXELS THE MINOR AXIS HAS ADVANCED
+// MAX(0, CEIL((2N * MINOR - MAJOR) / (2 * MAJOR))), SO ANY PIXEL RANGE CAN BE DRAWN ON ITS OWN.
+struct LineSetup
+{
+    int64_t major;  // fixed point deltas along the major and minor axis
+    int64_t minor;
+    int x;          // first pixel
+    int y;
+    int lastX;      // last pixel
+    int lastY;
+    int steps;      // pixel count (0 = nothing to draw)
+    int8_t sx;      // step directions
+    int8_t sy;
+    bool xMajor;
+};
 
-    // LINE COLLISION CHECK (IF UA & UB ARE BETWEEN 0-1)
-    if (uA >= 0 && uA <= 1 && uB >= 0 && uB <= 1) {
+// MINOR AXIS STEPS TAKEN BEFORE PIXEL N
+int64_t LineMinorSteps(const LineSetup &line, int64_t n)
+{
+    int64_t numerator = 2 * n * line.minor - line.major;
+    if (numerator <= 0) return 0;
+    return (numerator + 2 * line.major - 1) / (2 * line.major);
+}
+
+// CLIP A SCREEN SPACE SEGMENT TO [minX, maxX] x [minY, maxY] (LIANG-BARSKY), RETURNS FALSE IF NOTHING REMAINS
+bool ClipSegmentToRect(glm::vec2 &v1, glm::vec2 &v2, float minX, float minY, float maxX, float maxY)
+{
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    float dx = v2.x - v1.x;
+    float dy = v2.y - v1.y;
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {v1.x - minX, maxX - v1.x, v1.y - minY, maxY - v1.y};
 
-        // CALCULATE INTERSECTION COORDINATE
-        intersection = {x1 + (uA * (x2-x1)), y1 + (uA * (y2-y1))};
+    for (int i = 0; i < 4; ++i)
+    {
+        if (p[i] == 0.0f)
+        {
+            if (q[i] < 0.0f) return false; // parallel and outside
+            continue;
+        }
+        float t = q[i] / p[i];
+        if (p[i] < 0.0f) t0 = std::max(t0, t);
+        else t1 = std::min(t1, t);
+        if (t0 > t1) return false;
     }
-    return intersection;
+
+    glm::vec2 start = v1;
+    if (t0 > 0.0f) v1 = start + t0 * glm::vec2(dx, dy);
+    if (t1 < 1.0f) v2 = start + t1 * glm::vec2(dx, dy);
+    return true;
 }
 
-glm::vec4 LineWindowIntersection(float x1, float y1, float x2, float y2, float w, float h)
+// PREPARE A SCREEN SPACE LINE FOR AN IMAGE OF THE GIVEN SIZE
+LineSetup SetupLine(const glm::vec2 &v1, const glm::vec2 &v2, int imageWidth, int imageHeight, int guardBand)
 {
-    // TEST EACH WINDOW BORDER FOR AN INTERSECTION
-    glm::vec2 leftIntersection   = LineLineIntersection(x1, y1, x2, y2, 0, 0, 0, h);
-    glm::vec2 rightIntersection  = LineLineIntersection(x1, y1, x2, y2, w, 0, w, h);
-    glm::vec2 topIntersection    = LineLineIntersection(x1, y1, x2, y2, 0, 0, w, 0);
-    glm::vec2 bottomIntersection = LineLineIntersection(x1, y1, x2, y2, 0, h, w, h);
-    glm::vec4 intersections = {-1.0f, -1.0f, -1.0f, -1.0f};
+    LineSetup line = {};
+    if (!std::isfinite(v1.x) || !std::isfinite(v1.y) || !std::isfinite(v2.x) || !std::isfinite(v2.y)) return line;
+    float width = static_cast<float>(imageWidth);
+    float height = static_cast<float>(imageHeight);
 
-    if (leftIntersection.x != -1.0f)
+    // LINES INSIDE THE GUARD BAND ARE LEFT WHOLE, ONLY LINES REACHING BEYOND IT ARE CLIPPED TO THE VIEWPORT
+    glm::vec2 a = v1;
+    glm::vec2 b = v2;
+    float band = static_cast<float>(guardBand);
+    bool inside = a.x >= -band && a.x <= width + band && a.y >= -band && a.y <= height + band &&
+                  b.x >= -band && b.x <= width + band && b.y >= -band && b.y <= height + band;
+    if (!inside)
     {
-        intersections.x = leftIntersection.x;
-        intersections.y = leftIntersection.y;
+        const float inset = 1.0f / 1024.0f;
+        if (!ClipSegmentToRect(a, b, 0.0f, 0.0f, width - inset, height - inset)) return line;
     }
-    if (topIntersection.x != -1.0f)
+
+    // FIXED POINT DELTAS AND STEP DIRECTIONS
+    const float scale = static_cast<float>(1 << LINE_SUBPIXEL_BITS);
+    int64_t dx = static_cast<int64_t>(std::abs(b.x - a.x) * scale + 0.5f);
+    int64_t dy = static_cast<int64_t>(std::abs(b.y - a.y) * scale + 0.5f);
+    line.x = static_cast<int>(std::floor(a.x));
+    line.y = static_cast<int>(std::floor(a.y));
+    line.sx = (a.x < b.x) ? 1 : -1;
+    line.sy = (a.y < b.y) ? 1 : -1;
+    line.xMajor = dx >= dy;
+    line.major = line.xMajor ? dx : dy;
+    line.minor = line.xMajor ? dy : dx;
+
+    // PIXEL COUNT: THE FIRST N WHERE THE DISTANCE TRAVELLED (N MAJOR, M(N) MINOR STEPS) REACHES THE
+    // LENGTH. MAJOR / SCALE - 1 PIXELS NEVER REACH IT, SO STEP FORWARD FROM THERE (ONE DIVISION PER LINE).
+    int64_t lengthSquared = dx * dx + dy * dy;
+    int64_t steps = std::max<int64_t>(1, (line.major >> LINE_SUBPIXEL_BITS) - 1);
+    int64_t minorSteps = LineMinorSteps(line, steps);
+    int64_t decision = 2 * (steps + 1) * line.minor - line.major - 2 * minorSteps * line.major;
+    int64_t lastMinorSteps = 0;
+    while (((steps * steps + minorSteps * minorSteps) << (2 * LINE_SUBPIXEL_BITS)) < lengthSquared)
     {
-        intersections.x = topIntersection.x;
-        intersections.y = topIntersection.y; 
+        lastMinorSteps = minorSteps;
+        if (decision > 0)
+        {
+            ++minorSteps;
+            decision -= 2 * line.major;
+        }
+        decision += 2 * line.minor;
+        ++steps;
     }
-    if (rightIntersection.x != -1.0f)
+    line.steps = static_cast<int>(steps);
+    line.lastX = line.x + line.sx * static_cast<int>(line.xMajor ? steps - 1 : lastMinorSteps);
+    line.lastY = line.y + line.sy * static_cast<int>(line.xMajor ? lastMinorSteps : steps - 1);
+    return line;
+}
+
+// DRAW THE PIXELS OF A LINE THAT FALL INSIDE [minX, maxX) x [minY, maxY), WHICH MUST LIE WITHIN
+// THE FRAMEBUFFER. ONLY THE PART OF THE LINE CROSSING THE RECT IS STEPPED.
+template <bool XMajor>
+void RasterLineSpan(const LineSetup &line, int minX, int minY, int maxX, int maxY, uint32_t color, Framebuffer &framebuffer)
+{
+    int majorStart = XMajor ? line.x : line.y;
+    int majorStep = XMajor ? line.sx : line.sy;
+    int minorStart = XMajor ? line.y : line.x;
+    int minorStep = XMajor ? line.sy : line.sx;
+    int majorMin = XMajor ? minX : minY;
+    int majorMax = XMajor ? maxX : maxY;
+    int minorMin = XMajor ? minY : minX;
+    int minorMax = XMajor ? maxY : maxX;
+
+    // PIXELS [first, last) OF THE LINE WHOSE MAJOR COORDINATE LIES IN THE RECT
+    int64_t first = (majorStep > 0) ? majorMin - majorStart : majorStart - majorMax + 1;
+    int64_t last = (majorStep > 0) ? majorMax - majorStart : majorStart - majorMin + 1;
+    first = std::max<int64_t>(first, 0);
+    last = std::min<int64_t>(last, line.steps);
+    if (first >= last) return;
+
+    // RESUME THE STEPPING AT THE FIRST PIXEL: THE MINOR AXIS STEPS AFTER PIXEL I WHEN THE DECISION IS POSITIVE
+    int64_t minorSteps = (first > 0) ? LineMinorSteps(line, first) : 0;
+    int64_t decision = 2 * (first + 1) * line.minor - line.major - 2 * minorSteps * line.major;
+    int majorCoord = majorStart + majorStep * static_cast<int>(first);
+    int minorCoord = minorStart + minorStep * static_cast<int>(minorSteps);
+    uint32_t *pixels = framebuffer.Data();
+    ptrdiff_t width = framebuffer.width;
+
+    for (int64_t i = first; i < last; ++i)
     {
-        intersections.z = rightIntersection.x;
-        intersections.w = rightIntersection.y;
+        if (minorCoord >= minorMin && minorCoord < minorMax)
+        {
+            if (XMajor) pixels[static_cast<ptrdiff_t>(minorCoord) * width + majorCoord] = color;
+            else pixels[static_cast<ptrdiff_t>(majorCoord) * width + minorCoord] = color;
+        }
+        else if ((minorStep > 0) == (minorCoord >= minorMax))
+        {
+            break; // LEFT THE RECT ALONG THE MINOR AXIS
+        }
+
+        // DETERMINE NEXT STEP
+        majorCoord += majorStep;
+        if (decision > 0)
+        {
+            minorCoord += minorStep;
+            decision -= 2 * line.major;
+        }
+        decision += 2 * line.minor;
     }
-    if (bottomIntersection.x != -1.0f)
+}
+
+void RasterLineInRect(const LineSetup &line, int minX, int minY, int maxX, int maxY, uint32_t color, Framebuffer &framebuffer)
+{
+    if (line.xMajor) RasterLineSpan<true>(line, minX, minY, maxX, maxY, color, framebuffer);
+    else RasterLineSpan<false>(line, minX, minY, maxX, maxY, color, framebuffer);
+}
+
+// OUTCODE BITS (ONE PER CLIP SPACE PLANE THE VERTEX LIES BEYOND)
+const unsigned int OUT_LEFT   = 1;
+const unsigned int OUT_RIGHT  = 2;
+const unsigned int OUT_BOTTOM = 4;
+const unsigned int OUT_TOP    = 8;
+const unsigned int OUT_NEAR   = 16;
+const unsigned int OUT_FAR    = 32;
+const unsigned int OUT_VIEW_VOLUME = 63;
+const unsigned int OUT_GUARD  = 64; // BEYOND THE GUARD BAND (X OR Y)
+
+// TRANSFORMED VERTEX (PADDED TO 32 BYTES SO A GATHER TOUCHES ONE CACHE LINE)
+struct ClipVertex
+{
+    glm::vec4 clip;
+    glm::vec2 screen;
+    unsigned int outcode;
+    unsigned int padding;
+};
+
+// CONTIGUOUS SLICE [BEGIN, END) OF A MESH ARRAY, OFFSET IS WHERE ITS RESULTS START IN A COMPACT OUTPUT
+struct WorkRange
+{
+    unsigned int begin;
+    unsigned int end;
+    unsigned int offset;
+};
+
+// WHICH EDGES DRAWWIREFRAME DRAWS: EVERY EDGE OF A FRONT FACE, OR ONLY THE OUTLINE (SILHOUETTES BETWEEN A
+// FRONT AND A BACK FACE, PLUS THE CREASES AND BOUNDARIES OF FRONT FACES)
+const int EDGE_MODE_ALL = 0;
+const int EDGE_MODE_OUTLINE = 1;
+
+// THE PER FRAME PASSES HAND OUT RANGES IN CHUNKS OF AT MOST THIS MANY ELEMENTS (A MULTIPLE OF 8)
+const unsigned int WORK_RANGE_SIZE = 4096;
+
+// PER-FRAME WORK OF ONE SIMPLIFIED LOD LEVEL (ITS OWN VERTICES, TRIANGLES AND EDGES)
+struct LODWork
+{
+    std::vector<unsigned int> chunks;      // chunks drawn at this level, in order
+    std::vector<ClipVertex> clipVertices;
+    std::vector<unsigned char> frontFacing;
+    std::vector<WorkRange> vertexRanges;
+    std::vector<WorkRange> triangleRanges;
+    std::vector<WorkRange> edgeRanges;
+};
+
+// PER-FRAME WORKING BUFFERS, KEPT BETWEEN FRAMES SO THEY ARE NOT REALLOCATED
+struct RenderContext
+{
+    std::vector<ClipVertex> clipVertices;
+    std::vector<unsigned char> frontFacing;
+    std::vector<unsigned int> frontFaces;  // compact list of front facing triangle ids
+    std::vector<unsigned int> threadCounts;
+    std::vector<LineSetup> lines;          // one slot per edge, steps = 0 when nothing is drawn
+    std::vector<unsigned int> tileCursors; // per thread and tile line counts, then write cursors
+    std::vector<unsigned int> tileStarts;  // first entry of each tile in tileLines (tile count + 1)
+    std::vector<unsigned int> tileLines;   // line indices grouped by tile
+    std::vector<unsigned int> nodeStack;   // BVH traversal (node, plane mask) pairs
+    std::vector<unsigned int> visibleNodes;
+    std::vector<WorkRange> visibleRanges;  // scratch for merging before chunking
+    std::vector<WorkRange> vertexRanges;   // chunks of the vertices, triangles and edges to process this frame
+    std::vector<WorkRange> triangleRanges;
+    std::vector<WorkRange> edgeRanges;
+    std::vector<WorkRange> hiddenRanges;   // triangles of back facing meshlets and simplified chunks (flags cleared, not tested)
+    std::vector<WorkRange> borderRanges;   // chunks of mesh.lodBorderEdges of the visible leaves
+    std::vector<LODWork> lodWork;          // levels 1 .. LOD_LEVELS - 1
+    bool guardBand = true;                 // false: clip every edge that leaves the viewport
+    int edgeMode = EDGE_MODE_ALL;
+    float lodPixelError = 1.0f;            // screen space error allowed for simplified chunks in pixels (0 = full detail)
+};
+
+// CLASSIFY A CLIP SPACE POINT AGAINST THE VIEW VOLUME -W <= X, Y, Z <= W AND THE GUARD BAND
+// |X| <= GX * W, |Y| <= GY * W (NO DIVIDE NEEDED)
+unsigned int ComputeOutcode(const glm::vec4 &clip, const glm::vec2 &guardScale)
+{
+    unsigned int outcode = 0;
+    if (clip.x < -clip.w) outcode |= OUT_LEFT;
+    if (clip.x > clip.w) outcode |= OUT_RIGHT;
+    if (clip.y < -clip.w) outcode |= OUT_BOTTOM;
+    if (clip.y > clip.w) outcode |= OUT_TOP;
+    if (clip.z < -clip.w) outcode |= OUT_NEAR;
+    if (clip.z > clip.w) outcode |= OUT_FAR;
+    float guardX = guardScale.x * clip.w;
+    float guardY = guardScale.y * clip.w;
+    if (clip.x < -guardX || clip.x > guardX || clip.y < -guardY || clip.y > guardY) outcode |= OUT_GUARD;
+    if (clip.x != clip.x || clip.y != clip.y || clip.z != clip.z || clip.w != clip.w) outcode |= OUT_NEAR; // NAN INPUT
+    return outcode;
+}
+
+// CONVERT NDC TO SCREEN SPACE
+glm::vec2 NDCToScreen(const glm::vec3 &ndc, int imageWidth, int imageHeight)
+{
+    return glm::vec2((ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - ndc.y) * 0.5f * imageHeight);
+}
+
+// NDC EXTENT OF THE GUARD BAND ALONG X AND Y
+glm::vec2 GuardBandScale(int imageWidth, int imageHeight, int guardBand)
+{
+    return glm::vec2(1.0f + 2.0f * guardBand / imageWidth, 1.0f + 2.0f * guardBand / imageHeight);
+}
+
+// SCALAR VERTEX KERNEL (GLM) FOR INTERLEAVED XYZ FLOATS [BEGIN, END)
+void TransformVerticesScalar(const float *vertices, unsigned int begin, unsigned int end, const glm::mat4 &mvp, int imageWidth, int imageHeight, const glm::vec2 &guardScale, ClipVertex *clipVertices)
+{
+    for (size_t i = begin; i < end; ++i)
     {
-        intersections.z = bottomIntersection.x;
-        intersections.w = bottomIntersection.y;
+        // APPLY MODEL VIEW PROJECTION AND PERSPECTIVE DIVISION
+        glm::vec4 clip = mvp * glm::vec4(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], 1.0f);
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+        ClipVertex &vertex = clipVertices[i];
+        vertex.clip = clip;
+        vertex.screen = NDCToScreen(ndc, imageWidth, imageHeight);
+        vertex.outcode = ComputeOutcode(clip, guardScale);
     }
-    return intersections;
 }
 
-glm::vec2 LineInWindowIntersection(float x1, float y1, float x2, float y2, float w, float h)
+#ifdef WIREFRAME_AVX2
+// AVX2 VERTEX KERNEL: 8 SOA VERTICES PER ITERATION, SAME OPERATION ORDER AS GLM SO RESULTS MATCH THE
+// SCALAR PATH BIT FOR BIT (NO FMA). THE 8 RESULTS ARE TRANSPOSED INTO 8 CLIPVERTEX STRUCTS.
+// BEGIN AND END ARE MULTIPLES OF 8 WITHIN THE PADDED STREAMS.
+__attribute__((target("avx2")))
+void TransformVerticesAVX2(const VertexStreams &streams, unsigned int begin, unsigned int end, const glm::mat4 &mvp, int imageWidth, int imageHeight, const glm::vec2 &guardScale, ClipVertex *clipVertices)
 {
-    // TEST EACH WINDOW BORDER FOR AN INTERSECTION
-    glm::vec2 leftIntersection   = LineLineIntersection(x1, y1, x2, y2, 0, 0, 0, h);
-    glm::vec2 rightIntersection  = LineLineIntersection(x1, y1, x2, y2, w, 0, w, h);
-    glm::vec2 topIntersection    = LineLineIntersection(x1, y1, x2, y2, 0, 0, w, 0);
-    glm::vec2 bottomIntersection = LineLineIntersection(x1, y1, x2, y2, 0, h, w, h);
-    glm::vec2 intersection = {-1.0f, -1.0f};
-
-    if (leftIntersection.x != -1.0f)
+    for (size_t i = begin; i < end; i += 8)
     {
-        intersection.x = leftIntersection.x;
-        intersection.y = leftIntersection.y;
+        __m256 x = _mm256_load_ps(streams.x.data() + i);
+        __m256 y = _mm256_load_ps(streams.y.data() + i);
+        __m256 z = _mm256_load_ps(streams.z.data() + i);
+
+        // CLIP = (M0 * X + M1 * Y) + (M2 * Z + M3)
+        __m256 clip[4];
+        for (int row = 0; row < 4; ++row)
+        {
+            __m256 add0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(mvp[0][row]), x), _mm256_mul_ps(_mm256_set1_ps(mvp[1][row]), y));
+            __m256 add1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(mvp[2][row]), z), _mm256_set1_ps(mvp[3][row]));
+            clip[row] = _mm256_add_ps(add0, add1);
+        }
+
+        // PERSPECTIVE DIVISION AND SCREEN MAPPING
+        __m256 ndcX = _mm256_div_ps(clip[0], clip[3]);
+        __m256 ndcY = _mm256_div_ps(clip[1], clip[3]);
+        __m256 one = _mm256_set1_ps(1.0f);
+        __m256 half = _mm256_set1_ps(0.5f);
+        __m256 screenX = _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(ndcX, one), half), _mm256_set1_ps(static_cast<float>(imageWidth)));
+        __m256 screenY = _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(one, ndcY), half), _mm256_set1_ps(static_cast<float>(imageHeight)));
+
+        // CLIP SPACE OUTCODES (UNORDERED COMPARE CATCHES NAN INPUT)
+        __m256 negW = _mm256_sub_ps(_mm256_setzero_ps(), clip[3]);
+        __m256i outcode = _mm256_setzero_si256();
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[0], negW, _CMP_LT_OQ)), _mm256_set1_epi32(OUT_LEFT)));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[0], clip[3], _CMP_GT_OQ)), _mm256_set1_epi32(OUT_RIGHT)));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[1], negW, _CMP_LT_OQ)), _mm256_set1_epi32(OUT_BOTTOM)));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[1], clip[3], _CMP_GT_OQ)), _mm256_set1_epi32(OUT_TOP)));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[2], negW, _CMP_LT_OQ)), _mm256_set1_epi32(OUT_NEAR)));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(clip[2], clip[3], _CMP_GT_OQ)), _mm256_set1_epi32(OUT_FAR)));
+        __m256 guardX = _mm256_mul_ps(_mm256_set1_ps(guardScale.x), clip[3]);
+        __m256 guardY = _mm256_mul_ps(_mm256_set1_ps(guardScale.y), clip[3]);
+        __m256 outsideX = _mm256_or_ps(_mm256_cmp_ps(clip[0], _mm256_sub_ps(_mm256_setzero_ps(), guardX), _CMP_LT_OQ), _mm256_cmp_ps(clip[0], guardX, _CMP_GT_OQ));
+        __m256 outsideY = _mm256_or_ps(_mm256_cmp_ps(clip[1], _mm256_sub_ps(_mm256_setzero_ps(), guardY), _CMP_LT_OQ), _mm256_cmp_ps(clip[1], guardY, _CMP_GT_OQ));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(_mm256_or_ps(outsideX, outsideY)), _mm256_set1_epi32(OUT_GUARD)));
+        __m256 unordered = _mm256_or_ps(_mm256_cmp_ps(clip[0], clip[1], _CMP_UNORD_Q), _mm256_cmp_ps(clip[2], clip[3], _CMP_UNORD_Q));
+        outcode = _mm256_or_si256(outcode, _mm256_and_si256(_mm256_castps_si256(unordered), _mm256_set1_epi32(OUT_NEAR)));
+
+        // 8X8 TRANSPOSE: ROWS (CLIP XYZW, SCREEN XY, OUTCODE, PADDING) -> ONE CLIPVERTEX PER ROW
+        __m256 r0 = clip[0], r1 = clip[1], r2 = clip[2], r3 = clip[3];
+        __m256 r4 = screenX, r5 = screenY, r6 = _mm256_castsi256_ps(outcode), r7 = _mm256_setzero_ps();
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+        __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+        __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+        __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+        __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+        __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+        __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+        float *out = reinterpret_cast<float*>(clipVertices + i);
+        _mm256_storeu_ps(out + 0,  _mm256_permute2f128_ps(s0, s4, 0x20));
+        _mm256_storeu_ps(out + 8,  _mm256_permute2f128_ps(s1, s5, 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(s2, s6, 0x20));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(s3, s7, 0x20));
+        _mm256_storeu_ps(out + 32, _mm256_permute2f128_ps(s0, s4, 0x31));
+        _mm256_storeu_ps(out + 40, _mm256_permute2f128_ps(s1, s5, 0x31));
+        _mm256_storeu_ps(out + 48, _mm256_permute2f128_ps(s2, s6, 0x31));
+        _mm256_storeu_ps(out + 56, _mm256_permute2f128_ps(s3, s7, 0x31));
     }
-    if (topIntersection.x != -1.0f)
+}
+#endif
+
+// RUNTIME CPUID CHECK FOR THE AVX2 KERNEL
+bool CPUSupportsAVX2()
+{
+#ifdef WIREFRAME_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// VERTEX STAGE: TRANSFORM EACH VERTEX IN THE RANGES ONCE PER FRAME (PARALLEL OVER VERTICES, NOT INDICES).
+// USES THE AVX2 KERNEL WHEN THE VERTICES HAVE SOA STREAMS AND THE CPU SUPPORTS IT.
+void TransformVertices(const float *vertices, unsigned int vertexCount, const VertexStreams &streams, const std::vector<WorkRange> &ranges, const glm::mat4 &mvp, int imageWidth, int imageHeight, const glm::vec2 &guardScale, std::vector<ClipVertex> &clipVertices)
+{
+    int rangeCount = static_cast<int>(ranges.size());
+
+#ifdef WIREFRAME_AVX2
+    if (streams.count == vertexCount && !streams.empty() && CPUSupportsAVX2())
     {
-        intersection.x = topIntersection.x;
-        intersection.y = topIntersection.y; 
+        clipVertices.resize(streams.PaddedCount());
+        #pragma omp parallel for schedule(dynamic)
+        for (int r = 0; r < rangeCount; ++r)
+        {
+            TransformVerticesAVX2(streams, ranges[r].begin, ranges[r].end, mvp, imageWidth, imageHeight, guardScale, clipVertices.data());
+        }
+        return;
     }
-    if (rightIntersection.x != -1.0f)
+#endif
+
+    clipVertices.resize(vertexCount);
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < rangeCount; ++r)
     {
-        intersection.x = rightIntersection.x;
-        intersection.y = rightIntersection.y;
+        TransformVerticesScalar(vertices, ranges[r].begin, std::min(ranges[r].end, vertexCount), mvp, imageWidth, imageHeight, guardScale, clipVertices.data());
     }
-    if (bottomIntersection.x != -1.0f)
+}
+
+// BACKFACE CULLING CHECK (FACE NORMAL AGAINST VECTOR FROM CAMERA TO ONE OF THE FACE VERTICES)
+bool FrontFacing(const Mesh &mesh, size_t face, const glm::vec3 &cameraPosition)
+{
+    unsigned int i1 = mesh.indices[face * 3];
+    unsigned int i2 = mesh.indices[face * 3 + 1];
+    unsigned int i3 = mesh.indices[face * 3 + 2];
+    glm::vec3 v1 = glm::vec3(mesh.vertices[i1 * 3], mesh.vertices[i1 * 3 + 1], mesh.vertices[i1 * 3 + 2]);
+    glm::vec3 v2 = glm::vec3(mesh.vertices[i2 * 3], mesh.vertices[i2 * 3 + 1], mesh.vertices[i2 * 3 + 2]);
+    glm::vec3 v3 = glm::vec3(mesh.vertices[i3 * 3], mesh.vertices[i3 * 3 + 1], mesh.vertices[i3 * 3 + 2]);
+    glm::vec3 faceNormal = glm::cross(v2 - v1, v3 - v1);
+    return glm::dot(faceNormal, v1 - cameraPosition) < 0.0f;
+}
+
+#ifdef WIREFRAME_AVX2
+// AVX2 CULL KERNEL: 8 PRECOMPUTED PLANES PER ITERATION, SAME OPERATION ORDER AS THE SCALAR LOOP (NO FMA).
+// BEGIN AND END ARE MULTIPLES OF 8 WITHIN THE PADDED PLANES.
+__attribute__((target("avx2")))
+void CullBackfacesAVX2(const FacePlanes &planes, unsigned int begin, unsigned int end, const glm::vec3 &cameraPosition, unsigned char *frontFacing)
+{
+    __m256 cameraX = _mm256_set1_ps(cameraPosition.x);
+    __m256 cameraY = _mm256_set1_ps(cameraPosition.y);
+    __m256 cameraZ = _mm256_set1_ps(cameraPosition.z);
+
+    for (size_t i = begin; i < end; i += 8)
     {
-        intersection.x = bottomIntersection.x;
-        intersection.y = bottomIntersection.y;
+        __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(planes.nx.data() + i), cameraX),
+                                                 _mm256_mul_ps(_mm256_load_ps(planes.ny.data() + i), cameraY)),
+                                   _mm256_mul_ps(_mm256_load_ps(planes.nz.data() + i), cameraZ));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(dot, _mm256_load_ps(planes.d.data() + i), _CMP_GT_OQ));
+        for (int k = 0; k < 8; ++k) frontFacing[i + k] = (mask >> k) & 1;
     }
-    return intersection;
 }
+#endif
 
-void DrawLine2D(const glm::vec2 &v1, const glm::vec2 &v2, sf::Image &image)
+// TEST THE CAMERA AGAINST THE PRECOMPUTED PLANES OF THE TRIANGLES IN THE RANGES (8 AT A TIME WITH AVX2)
+void CullFacePlanes(const FacePlanes &planes, const std::vector<WorkRange> &ranges, const glm::vec3 &cameraPosition, std::vector<unsigned char> &frontFacing)
 {
-    int imageWidth = image.getSize().x;
-    int imageHeight = image.getSize().y;
-    
-    // INITIALISE TRACKING COORDINATES
-    float x0 = v1.x;
-    float y0 = v1.y;
+    unsigned int triangleCount = static_cast<unsigned int>(planes.count);
+    int rangeCount = static_cast<int>(ranges.size());
+
+#ifdef WIREFRAME_AVX2
+    if (CPUSupportsAVX2())
+    {
+        frontFacing.resize(planes.PaddedCount());
+        #pragma omp parallel for schedule(dynamic)
+        for (int r = 0; r < rangeCount; ++r)
+        {
+            CullBackfacesAVX2(planes, ranges[r].begin, ranges[r].end, cameraPosition, frontFacing.data());
+        }
+        return;
+    }
+#endif
 
-    // HORIZONTAL AND VERTICAL DISTANCE COMPONENTS
-    float dx = std::abs(v2.x - x0);
-    float dy = std::abs(v2.y - y0);
+    frontFacing.resize(triangleCount);
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < rangeCount; ++r)
+    {
+        for (unsigned int i = ranges[r].begin; i < std::min(ranges[r].end, triangleCount); ++i)
+        {
+            float dot = planes.nx[i] * cameraPosition.x + planes.ny[i] * cameraPosition.y + planes.nz[i] * cameraPosition.z;
+            frontFacing[i] = dot > planes.d[i];
+        }
+    }
+}
 
-    // DETERMINE STEP DIRECTION
-    int sx = (x0 < v2.x) ? 1 : -1;
-    int sy = (y0 < v2.y) ? 1 : -1;
-    float err = dx - dy;
-    float distance = std::sqrt(dx * dx + dy * dy); 
+// BACKFACE CULLING PASS: ONE FLAG PER TRIANGLE IN THE RANGES. USES THE PLANES PRECOMPUTED AT LOAD, OR FALLS
+// BACK TO THE PER FACE TEST WHILE THE MESH HAS NONE (STILL STREAMING).
+void CullBackfaces(const Mesh &mesh, const std::vector<WorkRange> &ranges, const glm::vec3 &cameraPosition, std::vector<unsigned char> &frontFacing)
+{
+    unsigned int triangleCount = mesh.TriangleCount();
+    int rangeCount = static_cast<int>(ranges.size());
+    if (mesh.facePlanes.count == triangleCount && !mesh.facePlanes.empty())
+    {
+        CullFacePlanes(mesh.facePlanes, ranges, cameraPosition, frontFacing);
+        return;
+    }
 
-    while (true)
+    frontFacing.resize(triangleCount);
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < rangeCount; ++r)
     {
-        // CHECK IF PIXEL COORDINATES ARE WINTHIN IMAGE BOUNDS
-        int px = static_cast<int>(x0);
-        int py = static_cast<int>(y0);
-        if (px >= 0 && px < imageWidth && py >= 0 && py < imageHeight)
+        for (unsigned int i = ranges[r].begin; i < std::min(ranges[r].end, triangleCount); ++i)
         {
-            image.setPixel(px, py, sf::Color::White);
+            frontFacing[i] = FrontFacing(mesh, i, cameraPosition);
         }
+    }
+}
 
-        // DETERMINE NEXT STEP
-        float e2 = 2 * err;
-        if (e2 > -dy)
+// GATHER THE IDS OF THE FRONT FACING TRIANGLES, IN ORDER (PER THREAD COUNTS, PREFIX SUM, SCATTER)
+void CompactFrontFaces(int triangleCount, RenderContext &context)
+{
+    const unsigned char *frontFacing = context.frontFacing.data();
+
+    #pragma omp parallel
+    {
+        int threadCount = omp_get_num_threads();
+        int thread = omp_get_thread_num();
+        int begin = static_cast<int>(static_cast<int64_t>(triangleCount) * thread / threadCount);
+        int end = static_cast<int>(static_cast<int64_t>(triangleCount) * (thread + 1) / threadCount);
+
+        #pragma omp single
+        context.threadCounts.assign(threadCount + 1, 0);
+
+        unsigned int count = 0;
+        for (int i = begin; i < end; ++i) count += frontFacing[i];
+        context.threadCounts[thread + 1] = count;
+        #pragma omp barrier
+
+        #pragma omp single
         {
-            err -= dy;
-            x0 += sx;
+            for (int t = 0; t < threadCount; ++t) context.threadCounts[t + 1] += context.threadCounts[t];
+            context.frontFaces.resize(context.threadCounts[threadCount]);
         }
-        if (e2 < dx)
+
+        unsigned int *out = context.frontFaces.data() + context.threadCounts[thread];
+        for (int i = begin; i < end; ++i)
         {
-            err += dx;
-            y0 += sy;
+            if (frontFacing[i]) *out++ = i;
         }
+    }
+}
 
-        // END CONDITION (DISTANCE TRAVELLED >= LINE DISTANCE)
-        float distTraveled = std::sqrt((x0 - v1.x) * (x0 - v1.x) + (y0 - v1.y) * (y0 - v1.y)); 
-        if (distTraveled >= distance)
-            break;
+// SIGNED DISTANCE OF A CLIP SPACE POINT TO THE PLANE OF OUTCODE BIT N (INSIDE >= 0)
+float ClipPlaneDistance(const glm::vec4 &clip, int plane)
+{
+    switch (plane)
+    {
+        case 0:  return clip.w + clip.x; // LEFT
+        case 1:  return clip.w - clip.x; // RIGHT
+        case 2:  return clip.w + clip.y; // BOTTOM
+        case 3:  return clip.w - clip.y; // TOP
+        case 4:  return clip.w + clip.z; // NEAR
+        default: return clip.w - clip.z; // FAR
     }
 }
 
-void DrawWireframe(const Mesh &mesh, Camera &camera, sf::Image &image)
+// LIANG-BARSKY IN HOMOGENEOUS CLIP SPACE, BEFORE THE PERSPECTIVE DIVIDE, AGAINST THE PLANES IN THE
+// OUTCODE. END POINTS BEHIND THE CAMERA (W <= 0) ARE CUT AT THE NEAR PLANE. RETURNS FALSE IF NOTHING REMAINS.
+bool ClipSegmentHomogeneous(const glm::vec4 &c1, const glm::vec4 &c2, unsigned int outcode, float &t0, float &t1)
 {
-    int imageWidth = image.getSize().x;
-    int imageHeight = image.getSize().y;
+    t0 = 0.0f;
+    t1 = 1.0f;
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        if (!(outcode & (1u << plane))) continue;
+        float d1 = ClipPlaneDistance(c1, plane);
+        float d2 = ClipPlaneDistance(c2, plane);
+        if (d1 < 0.0f && d2 < 0.0f) return false;
+        if (d1 < 0.0f) t0 = std::max(t0, d1 / (d1 - d2)); // ENTERS THROUGH THIS PLANE
+        else if (d2 < 0.0f) t1 = std::min(t1, d1 / (d1 - d2)); // LEAVES THROUGH THIS PLANE
+        if (t0 > t1) return false;
+    }
+    return true;
+}
 
-    // CALCULATE MODEL VIEW PROJECTION
-    glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
-    glm::mat4 mvp = camera.ProjectionViewMatrix() * modelMat;
+// PREPARE AN EDGE FOR RASTERIZATION. EDGES WITH BOTH END POINTS BEYOND ONE PLANE ARE REJECTED BY THE
+// OUTCODE AND. EDGES INSIDE THE GUARD BAND AND DEPTH RANGE ARE NOT CLIPPED AT ALL (THE RASTERIZER ONLY
+// STEPS THEIR ON SCREEN PIXELS), THE REST ARE CLIPPED IN CLIP SPACE AND ONLY THEN DIVIDED.
+LineSetup SetupClippedEdge(const ClipVertex &v1, const ClipVertex &v2, int imageWidth, int imageHeight, int guardBand)
+{
+    if (v1.outcode & v2.outcode & OUT_VIEW_VOLUME) return LineSetup();
+
+    unsigned int outcode = v1.outcode | v2.outcode;
+    if (!(outcode & (OUT_NEAR | OUT_FAR | OUT_GUARD))) return SetupLine(v1.screen, v2.screen, imageWidth, imageHeight, guardBand);
+
+    float t0, t1;
+    if (!ClipSegmentHomogeneous(v1.clip, v2.clip, outcode & OUT_VIEW_VOLUME, t0, t1)) return LineSetup();
+
+    // UNCLIPPED END POINTS KEEP THEIR SCREEN POSITION SO EDGES STILL MEET AT SHARED VERTICES
+    glm::vec4 delta = v2.clip - v1.clip;
+    glm::vec2 a = v1.screen;
+    glm::vec2 b = v2.screen;
+    if (t0 > 0.0f)
+    {
+        glm::vec4 clip = v1.clip + t0 * delta;
+        a = NDCToScreen(glm::vec3(clip) / clip.w, imageWidth, imageHeight);
+    }
+    if (t1 < 1.0f)
+    {
+        glm::vec4 clip = v1.clip + t1 * delta;
+        b = NDCToScreen(glm::vec3(clip) / clip.w, imageWidth, imageHeight);
+    }
+    return SetupLine(a, b, imageWidth, imageHeight, guardBand);
+}
 
-    // DRAW EACH FACE IN PARALLEL (3 EDGES)
-    #pragma omp parallel for
-    for (int i = 0; i < mesh.indices.size(); i += 3)
-    {
-        // VERTICES FROM MESH VERTEX FLOATS
-        glm::vec3 v1 = glm::vec3(mesh.vertices[mesh.indices[i] * 3], mesh.vertices[mesh.indices[i] * 3 + 1], mesh.vertices[mesh.indices[i] * 3 + 2]);
-        glm::vec3 v2 = glm::vec3(mesh.vertices[mesh.indices[i + 1] * 3], mesh.vertices[mesh.indices[i + 1] * 3 + 1], mesh.vertices[mesh.indices[i + 1] * 3 + 2]);
-        glm::vec3 v3 = glm::vec3(mesh.vertices[mesh.indices[i + 2] * 3], mesh.vertices[mesh.indices[i + 2] * 3 + 1], mesh.vertices[mesh.indices[i + 2] * 3 + 2]);
-
-        // APPLY MODEL VIEW PROJECTION TRANSFORMATION (CONVERT TO CAMERA SPACE)
-        glm::vec4 v1_transformed = mvp * glm::vec4(v1, 1.0f);
-        glm::vec4 v2_transformed = mvp * glm::vec4(v2, 1.0f);
-        glm::vec4 v3_transformed = mvp * glm::vec4(v3, 1.0f);
-
-        // PERFORM PERSPECTIVE DIVISION (HANDLE W = 0 CASE LATER)
-        glm::vec3 v1_ndc = glm::vec3(v1_transformed) / v1_transformed.w;
-        glm::vec3 v2_ndc = glm::vec3(v2_transformed) / v2_transformed.w;
-        glm::vec3 v3_ndc = glm::vec3(v3_transformed) / v3_transformed.w;
-
-        // BACKFACE CULLING CHECK
-        glm::vec3 faceNormal = glm::cross(v2 - v1, v3 - v1); // Compute face normal
-        glm::vec3 camToVertex = v1 - camera.position; // Compute vector from camera to one of the face vertices
-        if (glm::dot(faceNormal, camToVertex) < 0.0f)
+// CALL VISIT(TILE INDEX) FOR EVERY SCREEN TILE THE LINE DRAWS A PIXEL IN. WALKS THE TILE COLUMNS
+// (OR ROWS) ALONG THE MAJOR AXIS AND USES THE CLOSED FORM STEPPING FOR THE MINOR AXIS RANGE IN EACH.
+template <typename Visit>
+void ForEachLineTile(const LineSetup &line, int imageWidth, int imageHeight, Visit visit)
+{
+    if (line.steps == 0) return;
+    int tilesX = (imageWidth + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (imageHeight + TILE_SIZE - 1) / TILE_SIZE;
+
+    // MOST LINES ARE SHORT AND STAY IN ONE TILE
+    int tileX = line.x / TILE_SIZE;
+    int tileY = line.y / TILE_SIZE;
+    bool onScreen = line.x >= 0 && line.y >= 0 && line.lastX >= 0 && line.lastY >= 0;
+    if (onScreen && tileX == line.lastX / TILE_SIZE && tileY == line.lastY / TILE_SIZE)
+    {
+        if (tileX < tilesX && tileY < tilesY) visit(tileY * tilesX + tileX);
+        return;
+    }
+    int majorStart = line.xMajor ? line.x : line.y;
+    int majorStep = line.xMajor ? line.sx : line.sy;
+    int minorStart = line.xMajor ? line.y : line.x;
+    int minorStep = line.xMajor ? line.sy : line.sx;
+    int majorSize = line.xMajor ? imageWidth : imageHeight;
+    int minorSize = line.xMajor ? imageHeight : imageWidth;
+
+    // MAJOR AXIS PIXEL RANGE, CLAMPED TO THE IMAGE
+    int majorEnd = line.xMajor ? line.lastX : line.lastY;
+    int majorLow = std::max(std::min(majorStart, majorEnd), 0);
+    int majorHigh = std::min(std::max(majorStart, majorEnd), majorSize - 1);
+
+    for (int majorTile = majorLow / TILE_SIZE; majorTile <= majorHigh / TILE_SIZE; ++majorTile)
+    {
+        // PIXELS [first, last) OF THE LINE IN THIS TILE COLUMN (OR ROW)
+        int tileMin = majorTile * TILE_SIZE;
+        int tileMax = std::min(tileMin + TILE_SIZE, majorSize);
+        int64_t first = (majorStep > 0) ? tileMin - majorStart : majorStart - tileMax + 1;
+        int64_t last = (majorStep > 0) ? tileMax - majorStart : majorStart - tileMin + 1;
+        first = std::max<int64_t>(first, 0);
+        last = std::min<int64_t>(last, line.steps);
+        if (first >= last) continue;
+
+        // MINOR AXIS RANGE COVERED BY THOSE PIXELS
+        int minorFirst = minorStart + minorStep * static_cast<int>(LineMinorSteps(line, first));
+        int minorLast = minorStart + minorStep * static_cast<int>(LineMinorSteps(line, last - 1));
+        int minorLow = std::max(std::min(minorFirst, minorLast), 0);
+        int minorHigh = std::min(std::max(minorFirst, minorLast), minorSize - 1);
+
+        for (int minorTile = minorLow / TILE_SIZE; minorLow <= minorHigh && minorTile <= minorHigh / TILE_SIZE; ++minorTile)
         {
-            // CHECK WHICH VERTICES ARE WITHIN THE NDC BOUNDS
-            int inCount = 0;
-            bool v1In = false;
-            bool v2In = false;
-            bool v3In = false;
-            if (glm::all(glm::greaterThanEqual(v1_ndc, glm::vec3(-1.0f))) && glm::all(glm::lessThanEqual(v1_ndc, glm::vec3(1.0f)))) {
-                inCount += 1;
-                v1In = true;
-            }
-            if (glm::all(glm::greaterThanEqual(v2_ndc, glm::vec3(-1.0f))) && glm::all(glm::lessThanEqual(v2_ndc, glm::vec3(1.0f)))) {
-                inCount += 1;
-                v2In = true;
-            }
-            if (glm::all(glm::greaterThanEqual(v3_ndc, glm::vec3(-1.0f))) && glm::all(glm::lessThanEqual(v3_ndc, glm::vec3(1.0f)))) {
-                inCount += 1;
-                v3In = true;
-            }
+            visit(line.xMajor ? minorTile * tilesX + majorTile : majorTile * tilesX + minorTile);
+        }
+    }
+}
 
-            if (inCount == 3)
-            {
-                // CONVERT NDC TO SCREEN SPACE
-                glm::vec2 v1_screen = glm::vec2((v1_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v1_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v2_screen = glm::vec2((v2_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v2_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v3_screen = glm::vec2((v3_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v3_ndc.y) * 0.5f * imageHeight);
-
-                // DRAW EDGES
-                DrawLine2D(v1_screen, v2_screen, image); // draw edge v1 v2
-                DrawLine2D(v1_screen, v3_screen, image); // draw edge v1 v3
-                DrawLine2D(v2_screen, v3_screen, image); // draw edge v2 v3
-            }
+// RASTERIZE THE PREPARED LINES RACE FREE: BIN THEM INTO SCREEN TILES, THEN LET EACH WORKER TAKE WHOLE
+// TILES FROM A SHARED QUEUE (DYNAMIC SCHEDULE) SO EVERY PIXEL IS WRITTEN BY ONE THREAD ONLY AND A
+// TILE STAYS IN THAT THREAD'S CACHE. BINS KEEP THE LINES IN SLOT ORDER, SO THE RESULT IS DETERMINISTIC.
+void RasterizeLines(RenderContext &context, uint32_t color, Framebuffer &framebuffer)
+{
+    int imageWidth = framebuffer.width;
+    int imageHeight = framebuffer.height;
+    int tilesX = (imageWidth + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (imageHeight + TILE_SIZE - 1) / TILE_SIZE;
+    int tileCount = tilesX * tilesY;
+    int lineCount = static_cast<int>(context.lines.size());
+    const LineSetup *lines = context.lines.data();
+    if (tileCount == 0) return;
+    context.tileStarts.resize(tileCount + 1);
 
-            // FORM A QUAD
-            if (inCount == 2)
-            {
-                glm::vec2 v1_screen = glm::vec2((v1_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v1_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v2_screen = glm::vec2((v2_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v2_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v3_screen = glm::vec2((v3_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v3_ndc.y) * 0.5f * imageHeight);
+    #pragma omp parallel
+    {
+        int threadCount = omp_get_num_threads();
+        int thread = omp_get_thread_num();
+        int begin = static_cast<int>(static_cast<int64_t>(lineCount) * thread / threadCount);
+        int end = static_cast<int>(static_cast<int64_t>(lineCount) * (thread + 1) / threadCount);
 
-                // V1 IS OUTSIDE THE NDC
-                if (!v1In)
-                {
-                    glm::vec2 v1v2_screen = LineInWindowIntersection(v1_screen.x, v1_screen.y, v2_screen.x, v2_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v1v3_screen = LineInWindowIntersection(v1_screen.x, v1_screen.y, v3_screen.x, v3_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v1v2_screen, v2_screen, image); // draw edge "v1v2 intersection" v2
-                    DrawLine2D(v1v3_screen, v3_screen, image); // draw edge "v1v3 intersection" v3
-                    DrawLine2D(v2_screen, v3_screen, image); // draw edge v2 v3
-                }
+        #pragma omp single
+        context.tileCursors.assign(static_cast<size_t>(threadCount) * tileCount, 0);
 
-                // V2 IS OUTSIDE THE NDC
-                if (!v2In)
-                {
-                    glm::vec2 v2v1_screen = LineInWindowIntersection(v2_screen.x, v2_screen.y, v1_screen.x, v1_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v2v3_screen = LineInWindowIntersection(v2_screen.x, v2_screen.y, v3_screen.x, v3_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v2v1_screen, v1_screen, image); // draw edge "v2v1 intersection" v1
-                    DrawLine2D(v2v3_screen, v3_screen, image); // draw edge "v2v3 intersection" v3
-                    DrawLine2D(v1_screen, v3_screen, image); // draw edge v1 v3
-                }
+        // COUNT EACH THREAD'S LINES PER TILE
+        unsigned int *cursors = context.tileCursors.data() + static_cast<size_t>(thread) * tileCount;
+        for (int i = begin; i < end; ++i)
+        {
+            ForEachLineTile(lines[i], imageWidth, imageHeight, [&](int tile) { ++cursors[tile]; });
+        }
+        #pragma omp barrier
 
-                // V3 IS OUTSIDE THE NDC
-                if (!v3In)
+        // PREFIX SUM (TILE MAJOR, THEN THREAD) TURNS THE COUNTS INTO WRITE CURSORS
+        #pragma omp single
+        {
+            unsigned int total = 0;
+            for (int tile = 0; tile < tileCount; ++tile)
+            {
+                context.tileStarts[tile] = total;
+                for (int t = 0; t < threadCount; ++t)
                 {
-                    glm::vec2 v3v2_screen = LineInWindowIntersection(v3_screen.x, v3_screen.y, v2_screen.x, v2_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v3v1_screen = LineInWindowIntersection(v3_screen.x, v3_screen.y, v1_screen.x, v1_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v3v2_screen, v2_screen, image); // draw edge "v3v2 intersection" v2
-                    DrawLine2D(v3v1_screen, v1_screen, image); // draw edge "v3v1 intersection" v1
-                    DrawLine2D(v2_screen, v1_screen, image); // draw edge v2 v1
+                    unsigned int &cursor = context.tileCursors[static_cast<size_t>(t) * tileCount + tile];
+                    unsigned int count = cursor;
+                    cursor = total;
+                    total += count;
                 }
             }
+            context.tileStarts[tileCount] = total;
+            context.tileLines.resize(total);
+        }
 
-            // FORM TRIANGLE
-            if (inCount == 1)
+        // SCATTER LINE INDICES INTO THE BINS
+        unsigned int *tileLines = context.tileLines.data();
+        for (int i = begin; i < end; ++i)
+        {
+            ForEachLineTile(lines[i], imageWidth, imageHeight, [&](int tile) { tileLines[cursors[tile]++] = i; });
+        }
+        #pragma omp barrier
+
+        // RASTERIZE ONE TILE AT A TIME, MARKING THE TILES THAT GET LINES FOR THE NEXT CLEAR AND THE UPLOAD
+        #pragma omp for schedule(dynamic, 1)
+        for (int tile = 0; tile < tileCount; ++tile)
+        {
+            if (context.tileStarts[tile] == context.tileStarts[tile + 1]) continue;
+            framebuffer.MarkDrawn(tile);
+            int minX = (tile % tilesX) * TILE_SIZE;
+            int minY = (tile / tilesX) * TILE_SIZE;
+            int maxX = std::min(minX + TILE_SIZE, imageWidth);
+            int maxY = std::min(minY + TILE_SIZE, imageHeight);
+            for (unsigned int k = context.tileStarts[tile]; k < context.tileStarts[tile + 1]; ++k)
             {
-                glm::vec2 v1_screen = glm::vec2((v1_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v1_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v2_screen = glm::vec2((v2_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v2_ndc.y) * 0.5f * imageHeight);
-                glm::vec2 v3_screen = glm::vec2((v3_ndc.x + 1.0f) * 0.5f * imageWidth, (1.0f - v3_ndc.y) * 0.5f * imageHeight);
+                RasterLineInRect(lines[tileLines[k]], minX, minY, maxX, maxY, color, framebuffer);
+            }
+        }
+    }
+}
 
-                // V1 IS INSIDE THE NDC
-                if (v1In)
-                {
-                    glm::vec2 v1v2_screen = LineInWindowIntersection(v2_screen.x, v2_screen.y, v1_screen.x, v1_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v1v3_screen = LineInWindowIntersection(v3_screen.x, v3_screen.y, v1_screen.x, v1_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v1v2_screen, v1_screen, image); // draw edge "v1v2 intersection" v2
-                    DrawLine2D(v1v3_screen, v1_screen, image); // draw edge "v1v3 intersection" v3
-                }
+// APPEND [BEGIN, END) TO RANGES SORTED BY BEGIN, EXTENDING THE LAST RANGE WHEN THEY OVERLAP OR TOUCH
+void AppendRange(std::vector<WorkRange> &ranges, unsigned int begin, unsigned int end)
+{
+    if (begin >= end) return;
+    if (!ranges.empty() && begin <= ranges.back().end)
+    {
+        ranges.back().end = std::max(ranges.back().end, end);
+        return;
+    }
+    ranges.push_back({begin, end, 0});
+}
 
-                // V2 IS INSIDE THE NDC
-                if (v2In)
-                {
-                    glm::vec2 v2v1_screen = LineInWindowIntersection(v1_screen.x, v1_screen.y, v2_screen.x, v2_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v2v3_screen = LineInWindowIntersection(v3_screen.x, v3_screen.y, v2_screen.x, v2_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v2v1_screen, v2_screen, image); // draw edge "v2v1 intersection" v1
-                    DrawLine2D(v2v3_screen, v2_screen, image); // draw edge "v2v1 intersection" v3
-                }
+// SPLIT SORTED, DISJOINT RANGES INTO CHUNKS OF AT MOST WORK_RANGE_SIZE ELEMENTS WHOSE OUTPUTS ARE
+// NUMBERED CONSECUTIVELY FROM OFFSET. RETURNS THE OUTPUT POSITION AFTER THE LAST ONE.
+unsigned int ChunkRanges(const std::vector<WorkRange> &ranges, std::vector<WorkRange> &chunks, unsigned int offset = 0)
+{
+    chunks.clear();
+    for (const WorkRange &range : ranges)
+    {
+        for (unsigned int begin = range.begin; begin < range.end;)
+        {
+            unsigned int end = begin + std::min(range.end - begin, WORK_RANGE_SIZE);
+            chunks.push_back({begin, end, offset});
+            offset += end - begin;
+            begin = end;
+        }
+    }
+    return offset;
+}
 
-                // V3 IS INSIDE THE NDC
-                if (v3In)
-                {
-                    glm::vec2 v3v2_screen = LineInWindowIntersection(v2_screen.x, v2_screen.y, v3_screen.x, v3_screen.y, imageWidth, imageHeight);
-                    glm::vec2 v3v1_screen = LineInWindowIntersection(v1_screen.x, v1_screen.y, v3_screen.x, v3_screen.y, imageWidth, imageHeight);
-                    DrawLine2D(v3v2_screen, v3_screen, image); // draw edge "v1v2 intersection" v2
-                    DrawLine2D(v3v1_screen, v3_screen, image); // draw edge "v3v1 intersection" v1
-                }
+// WIDEN A RANGE TO WHOLE 8 ELEMENT SIMD BLOCKS
+void AlignRange(unsigned int &begin, unsigned int &end)
+{
+    begin &= ~7u;
+    end = (end + 7) & ~7u;
+}
+
+// COARSEST LOD LEVEL OF A CHUNK WHOSE ERROR STAYS BELOW THE PIXEL BUDGET AT THE DISTANCE OF ITS BOUNDS.
+// LODSCALE IS THE PROJECTED SIZE IN PIXELS OF ONE UNIT AT DISTANCE ONE, DIVIDED BY THE BUDGET.
+int SelectLODLevel(const LODChunk &chunk, const BVHNode &node, const glm::vec3 &cameraPosition, float lodScale)
+{
+    float distance = glm::length(glm::clamp(cameraPosition, node.boundsMin, node.boundsMax) - cameraPosition);
+    int level = 0;
+    for (int l = 1; l < LOD_LEVELS; ++l)
+    {
+        if (chunk.error[l] * lodScale < distance && chunk.triangleCount[l] < node.triangleCount) level = l;
+    }
+    return level;
+}
+
+// CHUNK THE VERTICES, TRIANGLES AND EDGES OF THE CHUNKS DRAWN AT EACH SIMPLIFIED LEVEL. THEIR EDGE SLOTS
+// FOLLOW LINEOFFSET, RETURNS THE SLOT COUNT AFTER THE LAST LEVEL.
+unsigned int CollectLODRanges(const Mesh &mesh, unsigned int lineOffset, RenderContext &context)
+{
+    std::vector<WorkRange> &ranges = context.visibleRanges;
+    context.lodWork.resize(LOD_LEVELS - 1);
+    for (size_t l = 0; l < context.lodWork.size(); ++l)
+    {
+        LODWork &work = context.lodWork[l];
+        if (work.chunks.empty())
+        {
+            work.vertexRanges.clear();
+            work.triangleRanges.clear();
+            work.edgeRanges.clear();
+            continue;
+        }
+
+        int level = static_cast<int>(l) + 1;
+        ranges.clear();
+        for (unsigned int c : work.chunks)
+        {
+            unsigned int begin = mesh.lodChunks[c].firstVertex[level];
+            unsigned int end = begin + mesh.lodChunks[c].vertexCount[level];
+            AlignRange(begin, end);
+            AppendRange(ranges, begin, end);
+        }
+        ChunkRanges(ranges, work.vertexRanges);
+        ranges.clear();
+        for (unsigned int c : work.chunks)
+        {
+            unsigned int begin = mesh.lodChunks[c].firstTriangle[level];
+            unsigned int end = begin + mesh.lodChunks[c].triangleCount[level];
+            AlignRange(begin, end);
+            AppendRange(ranges, begin, end);
+        }
+        ChunkRanges(ranges, work.triangleRanges);
+        ranges.clear();
+        for (unsigned int c : work.chunks) AppendRange(ranges, mesh.lods[l].chunkEdges[c], mesh.lods[l].chunkEdges[c + 1]);
+        lineOffset = ChunkRanges(ranges, work.edgeRanges, lineOffset);
+    }
+    return lineOffset;
+}
+
+// SIZE THE PER FRAME LISTS FOR THE WHOLE MESH IN VIEW (EVERY LEAF A SEPARATE RANGE), SO TURNING THE CAMERA
+// NEVER GROWS THEM AND THE FRAME LOOP DOES NOT ALLOCATE ONCE THE MESH IS LOADED
+void ReserveVisibleRanges(const Mesh &mesh, RenderContext &context)
+{
+    size_t largest = std::max({mesh.vertices.size() / 3, mesh.indices.size() / 3, mesh.edges.size() + mesh.lodBorderEdges.size()});
+    size_t rangeCount = mesh.bvh.size() + largest / WORK_RANGE_SIZE + 1;
+    for (std::vector<WorkRange> *ranges : {&context.visibleRanges, &context.vertexRanges, &context.triangleRanges, &context.edgeRanges, &context.hiddenRanges, &context.borderRanges})
+    {
+        ranges->reserve(rangeCount);
+    }
+    context.visibleNodes.reserve(mesh.bvh.size());
+    size_t lineCount = mesh.edges.size() + mesh.lodBorderEdges.size();
+    for (size_t l = 0; l < mesh.lods.size() && l < context.lodWork.size(); ++l)
+    {
+        const MeshLOD &lod = mesh.lods[l];
+        LODWork &work = context.lodWork[l];
+        size_t lodRangeCount = mesh.lodChunks.size() + std::max({lod.vertices.size() / 3, lod.indices.size() / 3, lod.edges.size()}) / WORK_RANGE_SIZE + 1;
+        work.chunks.reserve(mesh.lodChunks.size());
+        work.vertexRanges.reserve(lodRangeCount);
+        work.triangleRanges.reserve(lodRangeCount);
+        work.edgeRanges.reserve(lodRangeCount);
+        lineCount += lod.edges.size();
+    }
+    context.lines.reserve(lineCount);
+}
+
+// FIND THE VERTICES, TRIANGLES AND EDGES OF THE BVH LEAVES INSIDE THE VIEW FRUSTUM AND CHUNK THEM INTO
+// THE CONTEXT RANGES, SO THE FRAME COST FOLLOWS WHAT IS ON SCREEN. WITHOUT A (MATCHING) BVH EVERYTHING
+// IS VISIBLE. LEAVES WHOSE MESHLET FACES AWAY KEEP ONLY THEIR VERTICES AND THE EDGES SHARED WITH OTHER
+// CLUSTERS, THEIR TRIANGLES GO TO THE HIDDEN RANGES. LOD CHUNKS FAR ENOUGH AWAY (LODSCALE > 0) ARE DRAWN
+// FROM A SIMPLIFIED LEVEL INSTEAD, THEIR FULL RESOLUTION TRIANGLES ARE HIDDEN. RETURNS THE NUMBER OF EDGE SLOTS.
+unsigned int CollectVisibleRanges(const Mesh &mesh, const Frustum &frustum, const glm::vec3 &cameraPosition, float lodScale, RenderContext &context)
+{
+    unsigned int vertexCount = mesh.VertexCount();
+    unsigned int triangleCount = mesh.TriangleCount();
+    unsigned int edgeCount = static_cast<unsigned int>(mesh.edges.size());
+    std::vector<WorkRange> &ranges = context.visibleRanges;
+    const std::vector<BVHNode> &nodes = mesh.bvh;
+    context.hiddenRanges.clear();
+    context.borderRanges.clear();
+    for (LODWork &work : context.lodWork) work.chunks.clear();
+    if (nodes.empty() || nodes[0].triangleCount != triangleCount || nodes[0].edgeEnd != edgeCount || edgeCount == 0)
+    {
+        ranges.assign(1, {0, vertexCount, 0});
+        AlignRange(ranges[0].begin, ranges[0].end);
+        ChunkRanges(ranges, context.vertexRanges);
+        ranges.assign(1, {0, triangleCount, 0});
+        AlignRange(ranges[0].begin, ranges[0].end);
+        ChunkRanges(ranges, context.triangleRanges);
+        ranges.assign(1, {0, edgeCount, 0});
+        return CollectLODRanges(mesh, ChunkRanges(ranges, context.edgeRanges), context);
+    }
+
+
+
+    // TRAVERSE THE BVH IN MEMORY ORDER (LEFT CHILD FIRST), SO VISIBLE NODES AND CHUNKS COME OUT SORTED. PLANES
+    // A PARENT IS INSIDE OF ARE NOT TESTED AGAIN. A NODE FULLY INSIDE THE FRUSTUM IS TAKEN WHOLE, UNLESS
+    // THERE ARE MESHLETS TO TEST AT THE LEAVES OR BORDER EDGES TO PICK UP THERE.
+    bool useMeshlets = !mesh.meshlets.empty();
+    bool useLODs = lodScale > 0.0f && mesh.lods.size() == LOD_LEVELS - 1 && mesh.lodBorderStarts.size() == nodes.size() + 1;
+    std::vector<unsigned int> &stack = context.nodeStack;
+    std::vector<unsigned int> &visible = context.visibleNodes;
+    stack.assign({0u, 0x3Fu});
+    visible.clear();
+    context.lodWork.resize(LOD_LEVELS - 1);
+    ReserveVisibleRanges(mesh, context);
+    while (!stack.empty())
+    {
+        unsigned int planeMask = stack.back();
+        stack.pop_back();
+        unsigned int n = stack.back();
+        stack.pop_back();
+        const BVHNode &node = nodes[n];
+        int result = TestFrustumAABB(frustum, node.boundsMin, node.boundsMax, planeMask);
+        if (result == FRUSTUM_OUTSIDE) continue;
+        if (useLODs && node.lodChunk != NO_LOD_CHUNK)
+        {
+            int level = SelectLODLevel(mesh.lodChunks[node.lodChunk], node, cameraPosition, lodScale);
+            if (level > 0)
+            {
+                context.lodWork[level - 1].chunks.push_back(node.lodChunk);
+                context.hiddenRanges.push_back({node.firstTriangle, node.firstTriangle + node.triangleCount, 0});
+                continue;
+            }
+        }
+        if (node.rightChild == 0 || (result == FRUSTUM_INSIDE && !useMeshlets && !useLODs))
+        {
+            visible.push_back(n);
+            continue;
+        }
+        stack.insert(stack.end(), {node.rightChild, planeMask, n + 1, planeMask});
+    }
+
+
+
+    // TRIANGLE AND EDGE RANGES ARE ALREADY IN ORDER (HIDDEN RANGES NEED NOT BE). EDGES OWNED BY A SIMPLIFIED
+    // CHUNK ARE ALSO LISTED AT THE LEAF OF THEIR OTHER FACE, AN EDGE BETWEEN TWO FULL RESOLUTION CHUNKS MAY
+    // THEN BE SET UP TWICE (THE SAME PIXELS).
+    ranges.clear();
+    context.edgeRanges.clear();
+    std::vector<WorkRange> &borderEdges = context.borderRanges;
+    for (unsigned int n : visible)
+    {
+        const BVHNode &node = nodes[n];
+        unsigned int begin = node.firstTriangle;
+        unsigned int end = begin + node.triangleCount;
+        if (useMeshlets && node.rightChild == 0 && MeshletBackFacing(mesh.meshlets[node.meshlet], cameraPosition))
+        {
+            context.hiddenRanges.push_back({begin, end, 0});
+            AppendRange(context.edgeRanges, node.edgeBegin, mesh.meshlets[node.meshlet].externalEnd);
+            continue;
+        }
+        AlignRange(begin, end);
+        AppendRange(ranges, begin, end);
+        AppendRange(context.edgeRanges, node.edgeBegin, node.edgeEnd);
+        if (useLODs) AppendRange(borderEdges, mesh.lodBorderStarts[n], mesh.lodBorderStarts[n + 1]);
+    }
+    ChunkRanges(ranges, context.triangleRanges);
+    ranges.swap(context.edgeRanges);
+    unsigned int lineCount = ChunkRanges(ranges, context.edgeRanges);
+    ranges.swap(borderEdges);
+    lineCount = ChunkRanges(ranges, borderEdges, lineCount);
+    lineCount = CollectLODRanges(mesh, lineCount, context);
+
+    // VERTEX RANGES OF NEIGHBOURING NODES MAY OVERLAP, SORT BEFORE MERGING
+    std::vector<WorkRange> &vertexRanges = context.vertexRanges;
+    vertexRanges.clear();
+    for (unsigned int n : visible)
+    {
+        unsigned int begin = nodes[n].vertexBegin;
+        unsigned int end = nodes[n].vertexEnd;
+        AlignRange(begin, end);
+        vertexRanges.push_back({begin, end, 0});
+    }
+    std::sort(vertexRanges.begin(), vertexRanges.end(), [](const WorkRange &a, const WorkRange &b) { return a.begin < b.begin; });
+    ranges.clear();
+    for (const WorkRange &range : vertexRanges) AppendRange(ranges, range.begin, range.end);
+    ChunkRanges(ranges, context.vertexRanges);
+    return lineCount;
+}
+
+// SET UP EACH EDGE IN THE RANGES ONCE IF EITHER ADJACENT FACE IS FRONT FACING (GATHER ONLY, NO TRANSFORMS).
+// WITH FEATURES (OUTLINE MODE) THE EDGE MUST ALSO BE A SILHOUETTE OR A FEATURE EDGE. EDGEIDS MAPS RANGE
+// POSITIONS TO EDGES WHEN THE RANGES INDEX A LIST OF EDGES (NULL: THE EDGES THEMSELVES), EDGEVERTICES THEN
+// OPTIONALLY GIVES THE TWO ENDS OF EACH LIST ENTRY (INSTEAD OF THE EDGE'S OWN V0 AND V1).
+// A NEIGHBOUR FACE IN A CULLED NODE MAY HAVE A STALE FLAG, BUT THEN THE EDGE IS OFF SCREEN ANYWAY.
+void SetupEdgeLines(const MeshEdge *edges, const unsigned int *edgeIds, const unsigned int *edgeVertices, const unsigned char *features, const std::vector<WorkRange> &ranges, const unsigned char *frontFacing, const ClipVertex *clipVertices, int imageWidth, int imageHeight, int guardBand, LineSetup *lines)
+{
+    int rangeCount = static_cast<int>(ranges.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < rangeCount; ++r)
+    {
+        const WorkRange &range = ranges[r];
+        for (unsigned int i = range.begin; i < range.end; ++i)
+        {
+            unsigned int id = edgeIds ? edgeIds[i] : i;
+            const MeshEdge &edge = edges[id];
+            LineSetup &line = lines[range.offset + (i - range.begin)];
+            bool front0 = frontFacing[edge.face0] != 0;
+            bool front1 = edge.face1 != NO_FACE && frontFacing[edge.face1] != 0;
+            if (!(front0 || front1) || (features && !features[id] && front0 == front1))
+            {
+                line = LineSetup();
+                continue;
             }
+            unsigned int v0 = edgeVertices ? edgeVertices[i * 2] : edge.v0;
+            unsigned int v1 = edgeVertices ? edgeVertices[i * 2 + 1] : edge.v1;
+            line = SetupClippedEdge(clipVertices[v0], clipVertices[v1], imageWidth, imageHeight, guardBand);
         }
     }
 }
 
+void DrawWireframe(const Mesh &mesh, Camera &camera, Framebuffer &framebuffer, RenderContext &context)
+{
+    int imageWidth = framebuffer.width;
+    int imageHeight = framebuffer.height;
 
+    // CALCULATE MODEL VIEW PROJECTION
+    glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
+    glm::mat4 mvp = camera.ProjectionViewMatrix() * modelMat;
+    int triangleCount = mesh.TriangleCount();
+
+
+
+    // KEEP ONLY THE PARTS OF THE MESH INSIDE THE VIEW FRUSTUM (THE MODEL MATRIX IS THE IDENTITY, SO THE
+    // CAMERA'S WORLD SPACE PLANES APPLY TO THE MESH AS IS) AND PICK THE LOD LEVEL OF EACH CHUNK
+    // (THE OUTLINE MODE STAYS AT FULL RESOLUTION: FACING ACROSS A SIMPLIFIED CHUNK'S SEAM IS UNKNOWN)
+    bool outline = context.edgeMode == EDGE_MODE_OUTLINE && mesh.edgeFeatures.size() == mesh.edges.size();
+    float lodScale = 0.0f;
+    if (context.lodPixelError > 0.0f && !outline) lodScale = camera.ProjectionMatrix()[1][1] * 0.5f * imageHeight / context.lodPixelError;
+    unsigned int lineCount = CollectVisibleRanges(mesh, camera.ViewFrustum(), camera.position, lodScale, context);
+
+
+
+    // TRANSFORM EACH UNIQUE VERTEX ONCE
+    int guardBand = context.guardBand ? GuardBandPixels(imageWidth, imageHeight) : 0;
+    glm::vec2 guardScale = GuardBandScale(imageWidth, imageHeight, guardBand);
+    TransformVertices(mesh.vertices.data(), mesh.VertexCount(), mesh.vertexStreams, context.vertexRanges, mvp, imageWidth, imageHeight, guardScale, context.clipVertices);
+    const ClipVertex *clipVertices = context.clipVertices.data();
+
+
+
+    // DETERMINE WHICH FACES ARE FRONT FACING
+    CullBackfaces(mesh, context.triangleRanges, camera.position, context.frontFacing);
+    for (const WorkRange &range : context.hiddenRanges)
+    {
+        std::fill(context.frontFacing.begin() + range.begin, context.frontFacing.begin() + range.end, 0);
+    }
+    const unsigned char *frontFacing = context.frontFacing.data();
+
+
+
+    // NO EDGE LIST YET (E.G. MESH STILL STREAMING IN): SET UP EACH FRONT FACE IN PARALLEL (3 LINE SLOTS)
+    if (mesh.edges.empty())
+    {
+        CompactFrontFaces(triangleCount, context);
+        int faceCount = static_cast<int>(context.frontFaces.size());
+        const unsigned int *frontFaces = context.frontFaces.data();
+        context.lines.resize(static_cast<size_t>(faceCount) * 3);
+        LineSetup *lines = context.lines.data();
+        #pragma omp parallel for
+        for (int k = 0; k < faceCount; ++k)
+        {
+            unsigned int i = frontFaces[k];
+            LineSetup *faceLines = lines + static_cast<size_t>(k) * 3;
+            faceLines[0] = faceLines[1] = faceLines[2] = LineSetup();
+
+            // ONLY DRAW POLYGON EDGES, NOT TRIANGULATION DIAGONALS
+            unsigned char edgeMask = mesh.edgeMasks.size() > i ? mesh.edgeMasks[i] : 0x7;
+            const ClipVertex &v1 = clipVertices[mesh.indices[i * 3]];
+            const ClipVertex &v2 = clipVertices[mesh.indices[i * 3 + 1]];
+            const ClipVertex &v3 = clipVertices[mesh.indices[i * 3 + 2]];
+            if (edgeMask & 0x1) faceLines[0] = SetupClippedEdge(v1, v2, imageWidth, imageHeight, guardBand); // edge v1 v2
+            if (edgeMask & 0x4) faceLines[1] = SetupClippedEdge(v1, v3, imageWidth, imageHeight, guardBand); // edge v1 v3
+            if (edgeMask & 0x2) faceLines[2] = SetupClippedEdge(v2, v3, imageWidth, imageHeight, guardBand); // edge v2 v3
+        }
+        RasterizeLines(context, PIXEL_WHITE, framebuffer);
+        return;
+    }
+
+
+
+    // SIMPLIFIED CHUNKS: SAME VERTEX AND CULLING STAGES ON EACH LEVEL'S OWN ARRAYS
+    for (size_t l = 0; l < context.lodWork.size(); ++l)
+    {
+        LODWork &work = context.lodWork[l];
+        if (work.chunks.empty()) continue;
+        const MeshLOD &lod = mesh.lods[l];
+        TransformVertices(lod.vertices.data(), lod.VertexCount(), lod.vertexStreams, work.vertexRanges, mvp, imageWidth, imageHeight, guardScale, work.clipVertices);
+        CullFacePlanes(lod.facePlanes, work.triangleRanges, camera.position, work.frontFacing);
+    }
+
+
+
+    // SET UP EACH VISIBLE UNIQUE EDGE ONCE: FULL RESOLUTION EDGES, THE ONES ALONG SIMPLIFIED CHUNKS, THEN EACH LEVEL
+    context.lines.resize(lineCount);
+    LineSetup *lines = context.lines.data();
+    const unsigned char *features = outline ? mesh.edgeFeatures.data() : nullptr;
+    SetupEdgeLines(mesh.edges.data(), nullptr, nullptr, features, context.edgeRanges, frontFacing, clipVertices, imageWidth, imageHeight, guardBand, lines);
+    SetupEdgeLines(mesh.edges.data(), mesh.lodBorderEdges.data(), mesh.lodBorderVertices.data(), features, context.borderRanges, frontFacing, clipVertices, imageWidth, imageHeight, guardBand, lines);
+    for (size_t l = 0; l < context.lodWork.size(); ++l)
+    {
+        const LODWork &work = context.lodWork[l];
+        if (work.chunks.empty()) continue;
+        SetupEdgeLines(mesh.lods[l].edges.data(), nullptr, nullptr, nullptr, work.edgeRanges, work.frontFacing.data(), work.clipVertices.data(), imageWidth, imageHeight, guardBand, lines);
+    }
+
+
+
+    // DRAW THEM TILE BY TILE
+    RasterizeLines(context, PIXEL_WHITE, framebuffer);
+}
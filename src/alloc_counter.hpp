@@ -0,0 +1,66 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// COUNTS EVERY C++ HEAP ALLOCATION OF THE PROGRAM BY REPLACING THE GLOBAL OPERATOR NEW AND DELETE
+// (INCLUDE IT FROM ONE TRANSLATION UNIT ONLY). MEMORY TAKEN WITH MALLOC BY C LIBRARIES AND DRIVERS IS
+// NOT SEEN. THE FRAME LOOP COMPARES THE COUNT ACROSS A FRAME TO PROVE IT DOES NOT ALLOCATE. A DIAGNOSTIC:
+// ONLY BUILT WITH -DWIREFRAME_COUNT_ALLOCATIONS.
+std::atomic<size_t> heapAllocations{0};
+
+size_t HeapAllocationCount()
+{
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+void* CountedAllocate(size_t size)
+{
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+// OVER ALLOCATE AND KEEP THE MALLOC POINTER JUST BELOW THE ALIGNED BLOCK
+void* CountedAllocateAligned(size_t size, std::align_val_t alignment)
+{
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    void *base = CountedAllocate(size + align + sizeof(void*));
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + sizeof(void*) + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+    reinterpret_cast<void**>(aligned)[-1] = base;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void CountedFreeAligned(void *p)
+{
+    if (p) std::free(static_cast<void**>(p)[-1]);
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try { return CountedAllocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try { return CountedAllocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(size_t size, std::align_val_t alignment) { return CountedAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return CountedAllocateAligned(size, alignment); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { CountedFreeAligned(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { CountedFreeAligned(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { CountedFreeAligned(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { CountedFreeAligned(p); }
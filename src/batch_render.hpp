@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <omp.h>
+#include "../libs/glm/glm.hpp"
+#include "camera.h"
+#include "mesh.hpp"
+#include "framebuffer.hpp"
+#include "RenderSystem.hpp"
+#include "image_writer.hpp"
+#include "frame_writer.hpp"
+
+// ONE KEYFRAME OF A CAMERA PATH (CAMERA::POSITION AND CAMERA::ROTATION IN DEGREES)
+struct CameraKey
+{
+    glm::vec3 position;
+    glm::vec3 rotation;
+};
+
+// READ A CAMERA PATH FILE: ONE KEYFRAME PER LINE AS "X Y Z PITCH YAW ROLL", EMPTY LINES AND LINES
+// STARTING WITH # ARE SKIPPED. A TURNTABLE IS TWO KEYS WITH THE YAW GOING FROM 0 TO 360.
+bool LoadCameraPath(const std::string &filepath, std::vector<CameraKey> &keys)
+{
+    std::ifstream file(filepath);
+    if (!file)
+    {
+        std::cerr << "[CameraPath] Error: Could not open file '" << filepath << "'" << std::endl;
+        return false;
+    }
+    keys.clear();
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number)
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        std::istringstream values(line);
+        CameraKey key;
+        if (!(values >> key.position.x >> key.position.y >> key.position.z >> key.rotation.x >> key.rotation.y >> key.rotation.z))
+        {
+            std::cerr << "[CameraPath] Error: Line " << number << " of '" << filepath << "' is not 'x y z pitch yaw roll'" << std::endl;
+            return false;
+        }
+        keys.push_back(key);
+    }
+    if (keys.empty()) std::cerr << "[CameraPath] Error: No keyframes in '" << filepath << "'" << std::endl;
+    return !keys.empty();
+}
+
+// POSE AT T IN [0, 1], LINEAR BETWEEN EVENLY SPACED KEYFRAMES
+CameraKey CameraKeyAt(const std::vector<CameraKey> &keys, float t)
+{
+    if (keys.size() == 1) return keys[0];
+    float position = glm::clamp(t, 0.0f, 1.0f) * static_cast<float>(keys.size() - 1);
+    size_t index = std::min(static_cast<size_t>(position), keys.size() - 2);
+    float blend = position - static_cast<float>(index);
+    return {glm::mix(keys[index].position, keys[index + 1].position, blend), glm::mix(keys[index].rotation, keys[index + 1].rotation, blend)};
+}
+
+// TRUE IF PATTERN IS SAFE TO FORMAT WITH ONE FRAME NUMBER: EXACTLY ONE %d (OPTIONALLY WITH A WIDTH, E.G.
+// %04d) AND NO OTHER CONVERSION EXCEPT %%
+bool ValidFramePattern(const std::string &pattern)
+{
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] != '%') continue;
+        if (++i < pattern.size() && pattern[i] == '%') continue;
+        while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9') ++i;
+        if (i == pattern.size() || pattern[i] != 'd') return false;
+        ++conversions;
+    }
+    return conversions == 1;
+}
+
+// RENDER FRAMECOUNT FRAMES ALONG THE PATH AND WRITE THEM TO PATTERN (A PRINTF PATTERN WITH ONE INTEGER,
+// E.G. FRAMES/FRAME_%04d.PNG, SEE ValidFramePattern). FRAMES GO TO THE THREADS ONE AT A TIME, EACH WITH ITS OWN CAMERA,
+// RENDER CONTEXT AND FRAME WRITER, THE MESH IS ONLY READ. THE PIPELINE'S OWN PARALLEL LOOPS RUN ON THE
+// CALLING THREAD INSIDE A WORKER, AND EACH WORKER'S WRITER ENCODES ITS LAST FRAME WHILE IT RENDERS THE NEXT.
+bool RenderCameraPath(const Mesh &mesh, const std::vector<CameraKey> &keys, int frameCount, int width, int height, int edgeMode, const std::string &pattern)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::atomic<int> failures{0};
+    int maxActiveLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels(1);
+
+    #pragma omp parallel
+    {
+        Camera camera;
+        RenderContext context;
+        camera.SetViewport(width, height);
+        context.edgeMode = edgeMode;
+        std::vector<char> filepath(pattern.size() + 32);
+        FrameWriter writer(width, height, [&](int frame, const Framebuffer &framebuffer)
+        {
+            std::snprintf(filepath.data(), filepath.size(), pattern.c_str(), frame);
+            return WriteImage(filepath.data(), framebuffer);
+        });
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            Framebuffer *framebuffer = writer.Next();
+            if (!framebuffer) continue;
+            CameraKey key = CameraKeyAt(keys, frameCount > 1 ? static_cast<float>(frame) / static_cast<float>(frameCount - 1) : 0.0f);
+            camera.position = key.position;
+            camera.rotation = key.rotation;
+            camera.UpdateProjectionView();
+            framebuffer->Clear(PIXEL_BLACK);
+            DrawWireframe(mesh, camera, *framebuffer, context);
+            writer.Submit(frame);
+        }
+        if (!writer.Finish()) failures.fetch_add(1);
+    }
+
+    omp_set_max_active_levels(maxActiveLevels);
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "[RenderCameraPath] " << frameCount << " frames of " << width << "x" << height << " on " << omp_get_max_threads()
+              << " threads in " << seconds << " s (" << frameCount / seconds << " frames/s)" << std::endl;
+    return failures.load() == 0;
+}
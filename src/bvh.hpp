@@ -0,0 +1,265 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cfloat>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include "mesh.hpp"
+
+// LEAF SIZE AND SAH BIN COUNT OF THE TRIANGLE BVH (EACH LEAF BECOMES A MESHLET)
+const unsigned int BVH_LEAF_TRIANGLES = 128;
+const int BVH_BINS = 16;
+
+float BVHSurfaceArea(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    glm::vec3 extent = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+// BUILD THE SUBTREE OVER ORDER[BEGIN, END) INTO NODES[NODEINDEX] AND THE NODES THAT FOLLOW IT.
+// SPLITS AT THE CHEAPEST OF BVH_BINS CENTROID BINS PER AXIS (BINNED SAH), OR AT THE MEDIAN IF NO BIN SPLIT EXISTS.
+void BuildBVHNode(std::vector<BVHNode> &nodes, size_t nodeIndex, std::vector<unsigned int> &order, size_t begin, size_t end,
+                  const std::vector<glm::vec3> &triangleMin, const std::vector<glm::vec3> &triangleMax, const std::vector<glm::vec3> &centroids)
+{
+    // NODE AND CENTROID BOUNDS
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+    glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+    glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+    for (size_t i = begin; i < end; ++i)
+    {
+        unsigned int triangle = order[i];
+        boundsMin = glm::min(boundsMin, triangleMin[triangle]);
+        boundsMax = glm::max(boundsMax, triangleMax[triangle]);
+        centroidMin = glm::min(centroidMin, centroids[triangle]);
+        centroidMax = glm::max(centroidMax, centroids[triangle]);
+    }
+    nodes[nodeIndex].boundsMin = boundsMin;
+    nodes[nodeIndex].boundsMax = boundsMax;
+    nodes[nodeIndex].firstTriangle = static_cast<unsigned int>(begin);
+    nodes[nodeIndex].triangleCount = static_cast<unsigned int>(end - begin);
+    nodes[nodeIndex].rightChild = 0;
+    if (end - begin <= BVH_LEAF_TRIANGLES) return;
+
+
+
+    // BIN THE CENTROIDS ALONG EACH AXIS AND EVALUATE THE SAH COST OF EVERY BIN BOUNDARY
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (!(extent > 0.0f)) continue;
+        float binScale = BVH_BINS / extent;
+
+        size_t binCounts[BVH_BINS] = {};
+        glm::vec3 binMin[BVH_BINS];
+        glm::vec3 binMax[BVH_BINS];
+        std::fill(binMin, binMin + BVH_BINS, glm::vec3(FLT_MAX));
+        std::fill(binMax, binMax + BVH_BINS, glm::vec3(-FLT_MAX));
+        for (size_t i = begin; i < end; ++i)
+        {
+            unsigned int triangle = order[i];
+            int bin = std::min(static_cast<int>((centroids[triangle][axis] - centroidMin[axis]) * binScale), BVH_BINS - 1);
+            ++binCounts[bin];
+            binMin[bin] = glm::min(binMin[bin], triangleMin[triangle]);
+            binMax[bin] = glm::max(binMax[bin], triangleMax[triangle]);
+        }
+
+        // SWEEP FROM THE RIGHT, THEN FROM THE LEFT
+        float rightArea[BVH_BINS];
+        size_t rightCount[BVH_BINS];
+        glm::vec3 sweepMin = glm::vec3(FLT_MAX);
+        glm::vec3 sweepMax = glm::vec3(-FLT_MAX);
+        size_t count = 0;
+        for (int bin = BVH_BINS - 1; bin > 0; --bin)
+        {
+            sweepMin = glm::min(sweepMin, binMin[bin]);
+            sweepMax = glm::max(sweepMax, binMax[bin]);
+            count += binCounts[bin];
+            rightArea[bin] = BVHSurfaceArea(sweepMin, sweepMax);
+            rightCount[bin] = count;
+        }
+        sweepMin = glm::vec3(FLT_MAX);
+        sweepMax = glm::vec3(-FLT_MAX);
+        count = 0;
+        for (int bin = 0; bin < BVH_BINS - 1; ++bin)
+        {
+            sweepMin = glm::min(sweepMin, binMin[bin]);
+            sweepMax = glm::max(sweepMax, binMax[bin]);
+            count += binCounts[bin];
+            if (count == 0 || rightCount[bin + 1] == 0) continue;
+            float cost = BVHSurfaceArea(sweepMin, sweepMax) * count + rightArea[bin + 1] * rightCount[bin + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = bin + 1;
+            }
+        }
+    }
+
+
+
+    // PARTITION THE TRIANGLES
+    size_t middle;
+    if (bestAxis >= 0)
+    {
+        float binScale = BVH_BINS / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+        auto split = std::partition(order.begin() + begin, order.begin() + end, [&](unsigned int triangle)
+        {
+            return std::min(static_cast<int>((centroids[triangle][bestAxis] - centroidMin[bestAxis]) * binScale), BVH_BINS - 1) < bestSplit;
+        });
+        middle = split - order.begin();
+    }
+    else
+    {
+        // ALL CENTROIDS COINCIDE, SPLIT BY COUNT
+        middle = begin + (end - begin) / 2;
+    }
+
+
+
+    // CHILDREN IN DEPTH FIRST ORDER
+    size_t left = nodes.size();
+    nodes.emplace_back();
+    BuildBVHNode(nodes, left, order, begin, middle, triangleMin, triangleMax, centroids);
+    size_t right = nodes.size();
+    nodes.emplace_back();
+    BuildBVHNode(nodes, right, order, middle, end, triangleMin, triangleMax, centroids);
+    nodes[nodeIndex].rightChild = static_cast<unsigned int>(right);
+}
+
+// BUILD A BVH OVER THE MESH TRIANGLES AND REORDER THE TRIANGLES INTO LEAF ORDER AND THE VERTICES INTO
+// FIRST USE ORDER, SO EACH NODE'S TRIANGLES AND (MOSTLY) ITS VERTICES ARE CONTIGUOUS.
+// RUN BEFORE BuildEdges, BuildVertexStreams, BuildFacePlanes AND BuildMeshlets, WHICH DEPEND ON THE ORDER.
+void BuildBVH(Mesh &mesh)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    mesh.bvh.clear();
+    mesh.meshlets.clear();
+    mesh.lodChunks.clear();
+    mesh.lods.clear();
+    size_t triangleCount = mesh.indices.size() / 3;
+    size_t vertexCount = mesh.vertices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // THE REORDERING BELOW NEEDS EVERY INDEX TO NAME A VERTEX
+    const unsigned int *indices = mesh.indices.data();
+    if (*std::max_element(indices, indices + triangleCount * 3) >= vertexCount)
+    {
+        std::cerr << "[BuildBVH] Warning: Mesh indexes missing vertices, no BVH built" << std::endl;
+        return;
+    }
+
+
+
+    // TRIANGLE BOUNDS AND CENTROIDS
+    std::vector<glm::vec3> triangleMin(triangleCount);
+    std::vector<glm::vec3> triangleMax(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<unsigned int> order(triangleCount);
+    const float *vertices = mesh.vertices.data();
+    #pragma omp parallel for
+    for (long long face = 0; face < static_cast<long long>(triangleCount); ++face)
+    {
+        glm::vec3 corner[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int index = indices[face * 3 + k];
+            corner[k] = glm::vec3(vertices[index * 3], vertices[index * 3 + 1], vertices[index * 3 + 2]);
+        }
+        triangleMin[face] = glm::min(corner[0], glm::min(corner[1], corner[2]));
+        triangleMax[face] = glm::max(corner[0], glm::max(corner[1], corner[2]));
+        centroids[face] = (triangleMin[face] + triangleMax[face]) * 0.5f;
+        order[face] = static_cast<unsigned int>(face);
+    }
+
+    mesh.bvh.reserve(triangleCount / BVH_LEAF_TRIANGLES * 4 + 1);
+    mesh.bvh.emplace_back();
+    BuildBVHNode(mesh.bvh, 0, order, 0, triangleCount, triangleMin, triangleMax, centroids);
+
+
+
+    // REORDER TRIANGLES INTO LEAF ORDER AND NUMBER VERTICES BY FIRST USE (UNUSED VERTICES GO LAST)
+    std::vector<unsigned int> newIndices(triangleCount * 3);
+    std::vector<unsigned char> newEdgeMasks(mesh.edgeMasks.size() == triangleCount ? triangleCount : 0);
+    std::vector<unsigned int> vertexMap(vertexCount, 0xFFFFFFFF);
+    unsigned int nextVertex = 0;
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+        unsigned int face = order[i];
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int index = indices[face * 3 + k];
+            if (vertexMap[index] == 0xFFFFFFFF) vertexMap[index] = nextVertex++;
+            newIndices[i * 3 + k] = vertexMap[index];
+        }
+        if (!newEdgeMasks.empty()) newEdgeMasks[i] = mesh.edgeMasks[face];
+    }
+    std::vector<float> newVertices(vertexCount * 3);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        if (vertexMap[v] == 0xFFFFFFFF) vertexMap[v] = nextVertex++;
+        for (int k = 0; k < 3; ++k) newVertices[vertexMap[v] * 3 + k] = vertices[v * 3 + k];
+    }
+    mesh.vertices = MeshBuffer<float>(std::move(newVertices));
+    mesh.indices = MeshBuffer<unsigned int>(std::move(newIndices));
+    if (!newEdgeMasks.empty()) mesh.edgeMasks = MeshBuffer<unsigned char>(std::move(newEdgeMasks));
+
+
+
+    // VERTEX RANGES: LEAVES FROM THEIR INDICES, PARENTS FROM THEIR CHILDREN (WHICH ALWAYS FOLLOW THEM)
+    indices = mesh.indices.data();
+    for (size_t n = mesh.bvh.size(); n-- > 0;)
+    {
+        BVHNode &node = mesh.bvh[n];
+        node.edgeBegin = node.edgeEnd = node.meshlet = 0;
+        node.lodChunk = NO_LOD_CHUNK;
+        if (node.rightChild == 0)
+        {
+            unsigned int low = 0xFFFFFFFF;
+            unsigned int high = 0;
+            for (size_t i = node.firstTriangle * size_t(3); i < (node.firstTriangle + size_t(node.triangleCount)) * 3; ++i)
+            {
+                low = std::min(low, indices[i]);
+                high = std::max(high, indices[i]);
+            }
+            node.vertexBegin = low;
+            node.vertexEnd = high + 1;
+        }
+        else
+        {
+            const BVHNode &left = mesh.bvh[n + 1];
+            const BVHNode &right = mesh.bvh[node.rightChild];
+            node.vertexBegin = std::min(left.vertexBegin, right.vertexBegin);
+            node.vertexEnd = std::max(left.vertexEnd, right.vertexEnd);
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "[BuildBVH] " << triangleCount << " triangles -> " << mesh.bvh.size() << " nodes in " << milliseconds << " ms" << std::endl;
+}
+
+// FILL IN THE EDGE RANGE OF EVERY NODE. EDGES ARE ORDERED BY FACE0 (SEE BuildEdges), SO THE EDGES FIRST
+// USED BY A NODE'S CONTIGUOUS TRIANGLES ARE CONTIGUOUS TOO. RUN AFTER BuildEdges.
+void LinkBVHEdges(Mesh &mesh)
+{
+    auto firstEdgeOf = [&](unsigned int face)
+    {
+        auto edge = std::lower_bound(mesh.edges.begin(), mesh.edges.end(), face, [](const MeshEdge &e, unsigned int f) { return e.face0 < f; });
+        return static_cast<unsigned int>(edge - mesh.edges.begin());
+    };
+
+    #pragma omp parallel for
+    for (long long n = 0; n < static_cast<long long>(mesh.bvh.size()); ++n)
+    {
+        BVHNode &node = mesh.bvh[n];
+        node.edgeBegin = firstEdgeOf(node.firstTriangle);
+        node.edgeEnd = firstEdgeOf(node.firstTriangle + node.triangleCount);
+    }
+}
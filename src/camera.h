@@ -3,6 +3,7 @@
 
 #include "../libs/glm/glm.hpp"
 #include "../libs/glm/gtc/matrix_transform.hpp"
+#include "frustum.hpp"
 
 class Camera
 {
@@ -24,6 +25,11 @@ public:
         return projViewMat;
     }
 
+    const glm::mat4 ProjectionMatrix()
+    {
+        return projMatrix;
+    }
+
 
     void UpdateProjectionView()
     {
@@ -40,6 +46,9 @@ public:
         glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), negatedPosition);
         viewMatrix = rotationMatrix * translationMatrix;
         projViewMat = projMatrix * viewMatrix;
+
+        // World space frustum planes for culling
+        frustum = FrustumFromMatrix(projViewMat);
     }
 
     void SetViewport(int w, int h)
@@ -78,6 +87,12 @@ public:
         return glm::vec3(viewMatrix[0][1], viewMatrix[1][1], viewMatrix[2][1]);
     }
 
+    // Frustum planes as of the last UpdateProjectionView
+    const Frustum &ViewFrustum() const
+    {
+        return frustum;
+    }
+
     glm::vec3 position;
     glm::vec3 rotation;
 
@@ -85,6 +100,7 @@ private:
     glm::mat4 projMatrix;
     glm::mat4 viewMatrix;
     glm::mat4 projViewMat;
+    Frustum frustum;
 };
 
 #endif
\ No newline at end of file
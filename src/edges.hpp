@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+#include "mesh.hpp"
+
+// EDGES BETWEEN TRIANGLES WHOSE NORMALS ARE CLOSER THAN THIS ARE INSIDE A FLAT AREA (TIGHT, SO FINELY
+// TESSELLATED CURVED SURFACES KEEP THEIR EDGES)
+const float EDGE_COPLANAR_DOT = 0.999999f; // about 0.08 degrees
+
+// MAP EVERY VERTEX TO THE FIRST VERTEX AT THE SAME POSITION. EXPORTERS OFTEN DUPLICATE VERTICES PER FACE
+// (VOXEL AND CAD MESHES), WHICH WOULD LEAVE NEIGHBOURING FACES WITHOUT A SHARED EDGE.
+void WeldVertexIds(const float *vertices, size_t vertexCount, std::vector<unsigned int> &canonical)
+{
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) tableSize <<= 1;
+    std::vector<unsigned int> table(tableSize, UINT32_MAX);
+    canonical.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        // BIT PATTERNS AS THE KEY (+ 0.0F TURNS -0 INTO +0)
+        uint32_t bits[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            float value = vertices[v * 3 + k] + 0.0f;
+            std::memcpy(&bits[k], &value, sizeof(float));
+        }
+        uint64_t hash = (bits[0] * 0x9E3779B97F4A7C15ull) ^ (bits[1] * 0xC2B2AE3D27D4EB4Full) ^ (bits[2] * 0x165667B19E3779F9ull);
+        size_t slot = static_cast<size_t>(hash >> 16) & (tableSize - 1);
+        while (table[slot] != UINT32_MAX && std::memcmp(vertices + table[slot] * size_t(3), vertices + v * 3, sizeof(float) * 3) != 0)
+        {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == UINT32_MAX) table[slot] = static_cast<unsigned int>(v);
+        canonical[v] = table[slot];
+    }
+}
+
+// BUILD THE LIST OF UNIQUE UNDIRECTED EDGES AND THEIR ADJACENT TRIANGLES.
+// EDGES ARE ORDERED BY THE FIRST TRIANGLE THAT USES THEM (FACE0).
+// DIAGONALS ADDED BY TRIANGULATING POLYGONS (EDGE MASK BIT CLEAR) ARE LEFT OUT, EDGEMASKS MAY BE NULL.
+// WITH VERTICES, TRIANGLES ARE ADJACENT WHEN THEIR EDGE ENDS MATCH BY POSITION (THE EDGE KEEPS FACE0'S INDICES).
+void BuildEdgeList(const float *vertices, size_t vertexCount, const unsigned int *indices, const unsigned char *edgeMasks, size_t triangleCount, std::vector<MeshEdge> &edges)
+{
+    edges.clear();
+    if (triangleCount == 0) return;
+    std::vector<unsigned int> canonical;
+    if (vertices != nullptr) WeldVertexIds(vertices, vertexCount, canonical);
+
+
+
+    // OPEN ADDRESSING HASH TABLE FROM PACKED VERTEX PAIR TO EDGE ID (LOAD FACTOR <= 0.5)
+    size_t tableSize = 1;
+    while (tableSize < triangleCount * 3 * 2) tableSize <<= 1;
+    std::vector<uint64_t> keys(tableSize, UINT64_MAX);
+    std::vector<unsigned int> slots(tableSize);
+    edges.reserve(triangleCount * 3 / 2 + 1);
+
+
+
+    // VISIT THE 3 EDGES OF EVERY TRIANGLE
+    for (size_t face = 0; face < triangleCount; ++face)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int a = indices[face * 3 + corner];
+            unsigned int b = indices[face * 3 + (corner + 1) % 3];
+            unsigned int weldedA = canonical.empty() ? a : canonical[a];
+            unsigned int weldedB = canonical.empty() ? b : canonical[b];
+            if (weldedA == weldedB) continue; // degenerate edge
+            if (edgeMasks != nullptr && !(edgeMasks[face] & (1 << corner))) continue; // polygon diagonal
+            if (weldedA > weldedB)
+            {
+                std::swap(a, b);
+                std::swap(weldedA, weldedB);
+            }
+
+            uint64_t key = (static_cast<uint64_t>(weldedA) << 32) | weldedB;
+            size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 16) & (tableSize - 1);
+            while (keys[slot] != UINT64_MAX && keys[slot] != key) slot = (slot + 1) & (tableSize - 1);
+
+            // NEW EDGE
+            if (keys[slot] == UINT64_MAX)
+            {
+                keys[slot] = key;
+                slots[slot] = static_cast<unsigned int>(edges.size());
+                edges.push_back({a, b, static_cast<unsigned int>(face), NO_FACE});
+                continue;
+            }
+
+            // SHARED EDGE (NON-MANIFOLD EDGES START ANOTHER ENTRY ONCE TWO FACES ARE RECORDED)
+            MeshEdge &edge = edges[slots[slot]];
+            if (edge.face1 == NO_FACE && edge.face0 != face)
+            {
+                edge.face1 = static_cast<unsigned int>(face);
+            }
+            else if (edge.face0 != face)
+            {
+                slots[slot] = static_cast<unsigned int>(edges.size());
+                edges.push_back({a, b, static_cast<unsigned int>(face), NO_FACE});
+            }
+        }
+    }
+
+}
+
+// DROP THE EDGES WHOSE TWO TRIANGLES ARE COPLANAR (FLAT WALLS OF VOXEL AND CAD MESHES), KEEPING THE ORDER
+void RemoveCoplanarEdges(const float *vertices, const unsigned int *indices, std::vector<MeshEdge> &edges)
+{
+    auto normal = [&](unsigned int face)
+    {
+        const unsigned int *corners = indices + face * size_t(3);
+        glm::vec3 v1 = glm::vec3(vertices[corners[0] * 3], vertices[corners[0] * 3 + 1], vertices[corners[0] * 3 + 2]);
+        glm::vec3 v2 = glm::vec3(vertices[corners[1] * 3], vertices[corners[1] * 3 + 1], vertices[corners[1] * 3 + 2]);
+        glm::vec3 v3 = glm::vec3(vertices[corners[2] * 3], vertices[corners[2] * 3 + 1], vertices[corners[2] * 3 + 2]);
+        return glm::cross(v2 - v1, v3 - v1);
+    };
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const MeshEdge &edge)
+    {
+        if (edge.face1 == NO_FACE) return false;
+        glm::vec3 n0 = normal(edge.face0);
+        glm::vec3 n1 = normal(edge.face1);
+        float lengths = glm::length(n0) * glm::length(n1);
+        return lengths > 0.0f && glm::dot(n0, n1) > EDGE_COPLANAR_DOT * lengths;
+    }), edges.end());
+}
+
+// BUILD THE EDGE LIST OF THE MESH, WITHOUT EDGES INSIDE FLAT AREAS
+void BuildEdges(Mesh &mesh)
+{
+    size_t triangleCount = mesh.indices.size() / 3;
+    const unsigned char *edgeMasks = mesh.edgeMasks.size() == triangleCount ? mesh.edgeMasks.data() : nullptr;
+    BuildEdgeList(mesh.vertices.data(), mesh.VertexCount(), mesh.indices.data(), edgeMasks, triangleCount, mesh.edges);
+    if (triangleCount == 0) return;
+    size_t edgeCount = mesh.edges.size();
+    RemoveCoplanarEdges(mesh.vertices.data(), mesh.indices.data(), mesh.edges);
+
+    std::cout << "[BuildEdges] " << triangleCount << " triangles, " << triangleCount * 3 << " triangle edges -> "
+              << edgeCount << " unique edges, " << mesh.edges.size() << " after removing coplanar ones" << std::endl;
+}
+
+// DIHEDRAL ANGLE ABOVE WHICH AN EDGE IS A CREASE
+const float EDGE_CREASE_DEGREES = 30.0f;
+
+// FLAG THE EDGES THAT BELONG TO EVERY OUTLINE: CREASES (FACE NORMALS MORE THAN CREASEDEGREES APART) AND
+// BOUNDARIES (ONLY ONE FACE). RUN ONCE THE EDGE ORDER IS FINAL AND THE FACE PLANES ARE BUILT.
+void BuildEdgeFeatures(const std::vector<MeshEdge> &edges, const FacePlanes &planes, float creaseDegrees, std::vector<unsigned char> &features)
+{
+    float creaseCos = std::cos(glm::radians(creaseDegrees));
+    features.resize(edges.size());
+
+    #pragma omp parallel for
+    for (long long i = 0; i < static_cast<long long>(edges.size()); ++i)
+    {
+        const MeshEdge &edge = edges[i];
+        if (edge.face1 == NO_FACE)
+        {
+            features[i] = 1;
+            continue;
+        }
+        glm::vec3 n0 = glm::vec3(planes.nx[edge.face0], planes.ny[edge.face0], planes.nz[edge.face0]);
+        glm::vec3 n1 = glm::vec3(planes.nx[edge.face1], planes.ny[edge.face1], planes.nz[edge.face1]);
+        float lengths = glm::length(n0) * glm::length(n1);
+        features[i] = lengths > 0.0f && glm::dot(n0, n1) < creaseCos * lengths;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "../libs/glm/glm.hpp"
+#include "vertex_streams.hpp"
+
+// STRUCTURE-OF-ARRAYS TRIANGLE PLANES FOR SIMD BACKFACE CULLING. THE NORMAL IS THE UNNORMALIZED
+// CROSS(V2 - V1, V3 - V1) AND D = DOT(NORMAL, V1), SO A FACE IS FRONT FACING FROM P WHEN DOT(NORMAL, P) > D.
+// PADDING ENTRIES ARE ZERO AND NEVER FRONT FACING.
+struct FacePlanes
+{
+    AlignedFloats nx;
+    AlignedFloats ny;
+    AlignedFloats nz;
+    AlignedFloats d;
+    size_t count = 0; // real triangle count (arrays hold PaddedCount() elements)
+
+    size_t PaddedCount() const { return nx.size(); }
+    bool empty() const { return count == 0; }
+};
+
+// COMPUTE THE PLANE OF EVERY TRIANGLE (ONCE, AFTER LOADING)
+void BuildFacePlanes(const float *vertices, const unsigned int *indices, size_t triangleCount, FacePlanes &planes)
+{
+    size_t padded = (triangleCount + VERTEX_STREAM_PADDING - 1) / VERTEX_STREAM_PADDING * VERTEX_STREAM_PADDING;
+    planes.nx.assign(padded, 0.0f);
+    planes.ny.assign(padded, 0.0f);
+    planes.nz.assign(padded, 0.0f);
+    planes.d.assign(padded, 0.0f);
+    planes.count = triangleCount;
+
+    #pragma omp parallel for
+    for (long long face = 0; face < static_cast<long long>(triangleCount); ++face)
+    {
+        const unsigned int *corners = indices + face * 3;
+        glm::vec3 v1 = glm::vec3(vertices[corners[0] * 3], vertices[corners[0] * 3 + 1], vertices[corners[0] * 3 + 2]);
+        glm::vec3 v2 = glm::vec3(vertices[corners[1] * 3], vertices[corners[1] * 3 + 1], vertices[corners[1] * 3 + 2]);
+        glm::vec3 v3 = glm::vec3(vertices[corners[2] * 3], vertices[corners[2] * 3 + 1], vertices[corners[2] * 3 + 2]);
+        glm::vec3 normal = glm::cross(v2 - v1, v3 - v1);
+        planes.nx[face] = normal.x;
+        planes.ny[face] = normal.y;
+        planes.nz[face] = normal.z;
+        planes.d[face] = glm::dot(normal, v1);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "framebuffer.hpp"
+
+// HANDS FINISHED FRAMES TO A WRITER THREAD. TWO FRAMEBUFFERS ALTERNATE: THE CALLER DRAWS THE NEXT FRAME INTO
+// ONE WHILE THE WRITER ENCODES AND WRITES THE OTHER, SO THE CALLER ONLY WAITS ONCE BOTH ARE PENDING. FRAMES
+// ARE WRITTEN IN THE ORDER THEY ARE SUBMITTED. WRITE(FRAME, FRAMEBUFFER) RETURNS FALSE ON FAILURE.
+template <typename Write>
+class FrameWriter
+{
+public:
+    FrameWriter(int width, int height, Write writeFrame) : write(writeFrame)
+    {
+        for (Framebuffer &framebuffer : framebuffers) framebuffer.Resize(width, height);
+        writer = std::thread(&FrameWriter::Run, this);
+    }
+
+    ~FrameWriter()
+    {
+        Finish();
+    }
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // THE FRAMEBUFFER TO DRAW THE NEXT FRAME INTO, ONCE THE WRITER IS DONE WITH IT (NULL AFTER A FAILED WRITE)
+    Framebuffer* Next()
+    {
+        int slot = submitted % 2;
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !pending[slot] || failed; });
+        return failed ? nullptr : &framebuffers[slot];
+    }
+
+    // QUEUE THE FRAMEBUFFER RETURNED BY NEXT AS FRAME
+    void Submit(int frame)
+    {
+        int slot = submitted++ % 2;
+        std::lock_guard<std::mutex> lock(mutex);
+        frames[slot] = frame;
+        pending[slot] = true;
+        changed.notify_all();
+    }
+
+    // WRITE WHAT IS STILL PENDING AND STOP THE WRITER, FALSE IF ANY WRITE FAILED
+    bool Finish()
+    {
+        if (writer.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+                changed.notify_all();
+            }
+            writer.join();
+        }
+        return !failed;
+    }
+
+private:
+    Write write;
+    Framebuffer framebuffers[2];
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool pending[2] = {false, false}; // FRAMEBUFFER I HOLDS A FRAME THE WRITER HAS NOT FINISHED YET
+    int frames[2] = {0, 0};
+    int submitted = 0;
+    bool finished = false;
+    bool failed = false;
+
+    void Run()
+    {
+        for (int count = 0;; ++count)
+        {
+            int slot = count % 2;
+            int frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return pending[slot] || finished; });
+                if (!pending[slot]) return;
+                frame = frames[slot];
+            }
+            bool written = write(frame, framebuffers[slot]);
+            std::lock_guard<std::mutex> lock(mutex);
+            pending[slot] = false;
+            failed = failed || !written;
+            changed.notify_all();
+        }
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "aligned_allocator.hpp"
+
+// PIXELS ARE RGBA BYTES IN MEMORY (THE LAYOUT SF::TEXTURE::UPDATE EXPECTS), READ AS LITTLE ENDIAN UINT32
+const uint32_t PIXEL_BLACK = 0xFF000000;
+const uint32_t PIXEL_WHITE = 0xFFFFFFFF;
+
+// SCREEN TILE EDGE LENGTH FOR THE BINNED RASTERIZER (A 64X64 TILE IS 16 KB OF PIXELS), ALSO THE UNIT IN
+// WHICH THE FRAMEBUFFER TRACKS WHAT WAS DRAWN
+const int TILE_SIZE = 64;
+
+// CPU RENDER TARGET THE RASTERIZER WRITES INTO DIRECTLY. ROWS START ON A CACHE LINE
+// BOUNDARY (WHEN THE WIDTH IS A MULTIPLE OF 16) SO NEIGHBOURING SCREEN TILES NEVER SHARE ONE.
+// WIREFRAME FRAMES ARE MOSTLY BACKGROUND, SO IT KEEPS PER TILE FLAGS: CLEAR ONLY RESETS THE TILES DRAWN
+// SINCE THE LAST CLEAR, AND ONLY TILES THAT CHANGED SINCE THE LAST UPLOAD ARE HANDED OUT FOR UPLOAD.
+struct Framebuffer
+{
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    uint32_t clearColor = PIXEL_BLACK;
+    std::vector<uint32_t, AlignedAllocator<uint32_t, 64>> pixels;
+    std::vector<unsigned char> drawnTiles;   // written since the last clear (may hold more than the clear color)
+    std::vector<unsigned char> changedTiles; // drawn or cleared since the last upload
+    std::vector<uint32_t> packed;            // scratch for uploading a rectangle narrower than the image
+
+    // REALLOCATES ONLY WHEN THE SIZE CHANGES (EVERYTHING IS THEN UPLOADED AGAIN)
+    void Resize(int w, int h)
+    {
+        if (w == width && h == height) return;
+        width = w;
+        height = h;
+        tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+        pixels.assign(static_cast<size_t>(w) * h, clearColor);
+        drawnTiles.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+        changedTiles.assign(static_cast<size_t>(tilesX) * tilesY, 1);
+    }
+
+    // A NEW COLOR FILLS EVERYTHING, OTHERWISE ONLY THE TILES DRAWN SINCE THE LAST CLEAR ARE RESET
+    void Clear(uint32_t color)
+    {
+        if (color != clearColor)
+        {
+            clearColor = color;
+            std::fill(pixels.begin(), pixels.end(), color);
+            std::fill(drawnTiles.begin(), drawnTiles.end(), 0);
+            std::fill(changedTiles.begin(), changedTiles.end(), 1);
+            return;
+        }
+        for (int tile = 0; tile < tilesX * tilesY; ++tile)
+        {
+            if (!drawnTiles[tile]) continue;
+            int minX = (tile % tilesX) * TILE_SIZE;
+            int minY = (tile / tilesX) * TILE_SIZE;
+            int maxX = std::min(minX + TILE_SIZE, width);
+            int maxY = std::min(minY + TILE_SIZE, height);
+            for (int y = minY; y < maxY; ++y)
+            {
+                uint32_t *row = pixels.data() + static_cast<size_t>(y) * width;
+                std::fill(row + minX, row + maxX, color);
+            }
+            drawnTiles[tile] = 0;
+            changedTiles[tile] = 1;
+        }
+    }
+
+    // EVERY WRITE TO THE PIXELS MUST MARK ITS TILES (DIFFERENT TILES MAY BE MARKED FROM DIFFERENT THREADS)
+    void MarkDrawn(int tile)
+    {
+        drawnTiles[tile] = 1;
+        changedTiles[tile] = 1;
+    }
+
+    // VISIT(X, Y, W, H) FOR EACH RUN OF CHANGED TILES IN A TILE ROW, THEN FORGET THE CHANGES (THE CALLER
+    // UPLOADS THE RECTANGLES, SEE PACKRECT)
+    template <typename Visit>
+    void ForEachChangedRect(Visit visit)
+    {
+        for (int ty = 0; ty < tilesY; ++ty)
+        {
+            unsigned char *row = changedTiles.data() + static_cast<size_t>(ty) * tilesX;
+            for (int first = 0; first < tilesX; ++first)
+            {
+                if (!row[first]) continue;
+                int end = first;
+                while (end < tilesX && row[end]) row[end++] = 0;
+                int x = first * TILE_SIZE;
+                int y = ty * TILE_SIZE;
+                visit(x, y, std::min(end * TILE_SIZE, width) - x, std::min(y + TILE_SIZE, height) - y);
+                first = end;
+            }
+        }
+    }
+
+    // RGBA BYTES OF A RECTANGLE AS CONSECUTIVE ROWS: FULL WIDTH ROWS ARE ALREADY CONSECUTIVE, NARROWER
+    // RECTANGLES ARE COPIED TO THE SCRATCH BUFFER (VALID UNTIL THE NEXT CALL)
+    const uint8_t* PackRect(int x, int y, int w, int h)
+    {
+        if (x == 0 && w == width) return Bytes() + static_cast<size_t>(y) * width * sizeof(uint32_t);
+        if (packed.size() < static_cast<size_t>(w) * h) packed.resize(static_cast<size_t>(width) * TILE_SIZE);
+        for (int row = 0; row < h; ++row)
+        {
+            const uint32_t *source = pixels.data() + static_cast<size_t>(y + row) * width + x;
+            std::copy(source, source + w, packed.data() + static_cast<size_t>(row) * w);
+        }
+        return reinterpret_cast<const uint8_t*>(packed.data());
+    }
+
+    uint32_t* Data() { return pixels.data(); }
+    const uint32_t* Data() const { return pixels.data(); }
+    const uint8_t* Bytes() const { return reinterpret_cast<const uint8_t*>(pixels.data()); }
+};
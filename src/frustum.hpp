@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+#include "../libs/glm/glm.hpp"
+
+// SIX CLIP PLANES (LEFT, RIGHT, BOTTOM, TOP, NEAR, FAR) AS (NORMAL, D) WITH DOT(NORMAL, P) + D >= 0 INSIDE.
+// NORMALS ARE UNIT LENGTH, SO DOT(NORMAL, P) + D IS THE SIGNED DISTANCE OF P.
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// EXTRACT THE PLANES OF -W <= X, Y, Z <= W FROM A (MODEL) VIEW PROJECTION MATRIX (GRIBB-HARTMANN)
+Frustum FrustumFromMatrix(const glm::mat4 &m)
+{
+    glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;
+    frustum.planes[1] = row3 - row0;
+    frustum.planes[2] = row3 + row1;
+    frustum.planes[3] = row3 - row1;
+    frustum.planes[4] = row3 + row2;
+    frustum.planes[5] = row3 - row2;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        float length = glm::length(glm::vec3(frustum.planes[i]));
+        if (length > 0.0f) frustum.planes[i] /= length;
+    }
+    return frustum;
+}
+
+// RESULT OF A FRUSTUM TEST
+const int FRUSTUM_OUTSIDE = 0;
+const int FRUSTUM_INTERSECTS = 1;
+const int FRUSTUM_INSIDE = 2;
+
+// TEST AN AABB AGAINST THE PLANES SET IN PLANEMASK. PLANES THE BOX LIES FULLY INSIDE OF ARE CLEARED
+// FROM THE MASK SO CHILD BOXES DO NOT TEST THEM AGAIN.
+int TestFrustumAABB(const Frustum &frustum, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, unsigned int &planeMask)
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        if (!(planeMask & (1u << i))) continue;
+        const glm::vec4 &plane = frustum.planes[i];
+
+        // CORNER FURTHEST ALONG THE PLANE NORMAL (P-VERTEX) AND THE OPPOSITE ONE (N-VERTEX)
+        glm::vec3 positive = glm::vec3(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                                       plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                                       plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        glm::vec3 negative = glm::vec3(plane.x >= 0.0f ? boundsMin.x : boundsMax.x,
+                                       plane.y >= 0.0f ? boundsMin.y : boundsMax.y,
+                                       plane.z >= 0.0f ? boundsMin.z : boundsMax.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) return FRUSTUM_OUTSIDE;
+        if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f) planeMask &= ~(1u << i);
+    }
+    return planeMask == 0 ? FRUSTUM_INSIDE : FRUSTUM_INTERSECTS;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "framebuffer.hpp"
+
+// WRITE THE FRAMEBUFFER AS A BINARY PPM (P6) OR AN UNCOMPRESSED PNG, WITHOUT ANY IMAGE LIBRARY, SO FRAMES
+// CAN BE SAVED ON MACHINES WITHOUT A DISPLAY. THE ALPHA CHANNEL IS DROPPED.
+
+// RGB ROW Y OF THE FRAMEBUFFER
+void FramebufferRowRGB(const Framebuffer &framebuffer, int y, uint8_t *rgb)
+{
+    const uint8_t *rgba = framebuffer.Bytes() + static_cast<size_t>(y) * framebuffer.width * 4;
+    for (int x = 0; x < framebuffer.width; ++x)
+    {
+        rgb[x * 3] = rgba[x * 4];
+        rgb[x * 3 + 1] = rgba[x * 4 + 1];
+        rgb[x * 3 + 2] = rgba[x * 4 + 2];
+    }
+}
+
+bool WritePPM(const std::string &filepath, const Framebuffer &framebuffer)
+{
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "[WriteImage] Error: Could not open '" << filepath << "'" << std::endl;
+        return false;
+    }
+    file << "P6\n" << framebuffer.width << " " << framebuffer.height << "\n255\n";
+    std::vector<uint8_t> row(static_cast<size_t>(framebuffer.width) * 3);
+    for (int y = 0; y < framebuffer.height; ++y)
+    {
+        FramebufferRowRGB(framebuffer, y, row.data());
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return static_cast<bool>(file);
+}
+
+uint32_t PNGCrc(const uint8_t *data, size_t size, uint32_t crc = 0)
+{
+    // BUILT ONCE (THREAD SAFE, FRAMES MAY BE WRITTEN FROM SEVERAL THREADS)
+    static const std::array<uint32_t, 256> table = []
+    {
+        std::array<uint32_t, 256> entries;
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[n] = c;
+        }
+        return entries;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ZLIB STREAM OF STORED (UNCOMPRESSED) DEFLATE BLOCKS: LARGER FILES, BUT NO COMPRESSOR NEEDED AND FAST
+void PNGStoredZlib(const std::vector<uint8_t> &data, std::vector<uint8_t> &out)
+{
+    const size_t blockSize = 65535;
+    out.clear();
+    out.reserve(data.size() + data.size() / blockSize * 5 + 11);
+    out.insert(out.end(), {0x78, 0x01});
+    uint32_t a = 1, b = 0;
+    size_t position = 0;
+    do
+    {
+        size_t length = std::min(blockSize, data.size() - position);
+        bool last = position + length == data.size();
+        out.insert(out.end(), {static_cast<uint8_t>(last ? 1 : 0), static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                               static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8)});
+        out.insert(out.end(), data.begin() + position, data.begin() + position + length);
+        for (size_t i = position; i < position + length; ++i)
+        {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        position += length;
+    } while (position < data.size());
+    uint32_t adler = b << 16 | a;
+    out.insert(out.end(), {static_cast<uint8_t>(adler >> 24), static_cast<uint8_t>(adler >> 16), static_cast<uint8_t>(adler >> 8), static_cast<uint8_t>(adler)});
+}
+
+bool WritePNG(const std::string &filepath, const Framebuffer &framebuffer)
+{
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "[WriteImage] Error: Could not open '" << filepath << "'" << std::endl;
+        return false;
+    }
+
+    // EVERY ROW STARTS WITH FILTER TYPE 0 (NONE)
+    size_t stride = static_cast<size_t>(framebuffer.width) * 3 + 1;
+    std::vector<uint8_t> scanlines(stride * framebuffer.height);
+    for (int y = 0; y < framebuffer.height; ++y)
+    {
+        scanlines[y * stride] = 0;
+        FramebufferRowRGB(framebuffer, y, &scanlines[y * stride + 1]);
+    }
+    std::vector<uint8_t> compressed;
+    PNGStoredZlib(scanlines, compressed);
+
+    auto chunk = [&](const char *type, const uint8_t *data, size_t size)
+    {
+        uint8_t header[8] = {static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size),
+                             static_cast<uint8_t>(type[0]), static_cast<uint8_t>(type[1]), static_cast<uint8_t>(type[2]), static_cast<uint8_t>(type[3])};
+        uint32_t crc = PNGCrc(data, size, PNGCrc(header + 4, 4));
+        uint8_t footer[4] = {static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16), static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)};
+        file.write(reinterpret_cast<const char*>(header), 8);
+        file.write(reinterpret_cast<const char*>(data), size);
+        file.write(reinterpret_cast<const char*>(footer), 4);
+    };
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    uint32_t w = framebuffer.width, h = framebuffer.height;
+    const uint8_t header[13] = {static_cast<uint8_t>(w >> 24), static_cast<uint8_t>(w >> 16), static_cast<uint8_t>(w >> 8), static_cast<uint8_t>(w),
+                                static_cast<uint8_t>(h >> 24), static_cast<uint8_t>(h >> 16), static_cast<uint8_t>(h >> 8), static_cast<uint8_t>(h),
+                                8, 2, 0, 0, 0}; // 8 BIT RGB, NO INTERLACE
+    file.write(reinterpret_cast<const char*>(signature), 8);
+    chunk("IHDR", header, sizeof(header));
+    chunk("IDAT", compressed.data(), compressed.size());
+    chunk("IEND", nullptr, 0);
+    return static_cast<bool>(file);
+}
+
+// PICK THE FORMAT FROM THE EXTENSION (.PNG, ANYTHING ELSE IS PPM)
+bool WriteImage(const std::string &filepath, const Framebuffer &framebuffer)
+{
+    std::string extension = filepath.size() >= 4 ? filepath.substr(filepath.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".png") return WritePNG(filepath, framebuffer);
+    return WritePPM(filepath, framebuffer);
+}
@@ -1,125 +1,281 @@
 #pragma once
 
-#include <vector> 
+#include <vector>
 #include <string>
-#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
 #include <iostream>
+#include <omp.h>
 #include "mesh.hpp"
+#include "mapped_file.hpp"
+#include "mesh_cache.hpp"
+#include "voxel.hpp"
 
-// GENERATE NEW LIST OF TRIANGULATED INDICES FROM A LIST OF POLYGON INDICES
-std::vector<unsigned int> TriangulatePolygon(std::vector<unsigned int> &indices)
+// SKIP SPACES AND TABS WITHIN A LINE
+const char* SkipBlanks(const char *cursor, const char *end)
 {
-    std::vector<unsigned int> triangulatedIndices;
-    for (int i=0; i<indices.size()-2; ++i)
-    {
-        triangulatedIndices.push_back(indices[0]);
-        triangulatedIndices.push_back(indices[i+1]);
-        triangulatedIndices.push_back(indices[i+2]);
-    }
-    return triangulatedIndices;
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) ++cursor;
+    return cursor;
 }
 
-// LOAD OBJ FROM FILE INTO MESH CLASS
-Mesh LoadOBJ(std::string filepath)
+// SKIP TO THE END OF THE CURRENT TOKEN
+const char* SkipToken(const char *cursor, const char *end)
 {
-    Mesh mesh;
-    std::ifstream file(filepath);
+    while (cursor < end && *cursor != ' ' && *cursor != '\t' && *cursor != '\n' && *cursor != '\r') ++cursor;
+    return cursor;
+}
 
+// VERTICES AND TRIANGLES PARSED FROM ONE RANGE OF AN OBJ FILE
+struct OBJChunk
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned char> edgeMasks;
+    std::vector<size_t> relativeIndices; // slots holding chunk-local relative indices
+};
 
+// PARSE OBJ TEXT IN PLACE (NO PER-LINE OR PER-TOKEN ALLOCATIONS)
+void ParseOBJ(const char *cursor, const char *end, OBJChunk &chunk)
+{
+    std::vector<float> &vertices = chunk.vertices;
+    std::vector<unsigned int> &indices = chunk.indices;
 
-    // CHECK IF FILEPATH EXISTS
-    if (!file.is_open())
+    while (cursor < end)
     {
-        std::cerr << "[LoadOBJ] Error: Could not open file '" << filepath << "'" << std::endl;
-    }
-
-
-
-    // ITERATE OVER LINES
-    std::string line;
-    while (std::getline(file, line))
-    {   
-
-
-        
-        // TOKENISE THE LINE BY " " (SPACE DELIMITER)
-        std::vector<std::string> tokens;
-        std::string token;
-        for (char ch : line)
-        {
-            if (ch == ' ')
-            {
-                tokens.push_back(token);
-                token = "";
-            }
-            else
-            {
-                token += ch;
-            }
-        }
-        tokens.push_back(token); // append the last token
+        // FIND THE END OF THE LINE
+        const char *lineEnd = cursor;
+        while (lineEnd < end && *lineEnd != '\n') ++lineEnd;
+        cursor = SkipBlanks(cursor, lineEnd);
 
 
 
         // LINE CORRESPONDS TO A VERTEX
-        if (tokens[0] == "v")
+        if (lineEnd - cursor > 1 && cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
         {
-            for (int i=1; i<tokens.size(); ++i)
+            cursor += 1;
+            for (int i=0; i<3; ++i)
             {
-                mesh.vertices.push_back(std::stof(tokens[i])); 
+                cursor = SkipBlanks(cursor, lineEnd);
+                float value = 0.0f;
+                cursor = std::from_chars(cursor, lineEnd, value).ptr;
+                vertices.push_back(value);
             }
         }
 
 
 
         // LINE CORRESPONDS TO A FACE
-        if (tokens[0] == "f")
+        else if (lineEnd - cursor > 1 && cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
         {
-            // EXTRACT INDICES FROM LINE
-            std::vector<unsigned int> newIndices;
-            for (int i=1; i<tokens.size(); ++i)
-            {
-                std::string indexString;
+            cursor += 1;
+            long long vertexCount = static_cast<long long>(vertices.size() / 3);
+            unsigned int first = 0;
+            unsigned int previous = 0;
+            bool firstRelative = false;
+            bool previousRelative = false;
+            int corner = 0;
 
-                // EXTRACT FIRST NUMBER (VERTEX INDEX)
-                for (char ch : tokens[i])
-                {
-                    if (ch == '/') break;
-                    else {
-                        indexString += ch;
-                    }
-                }
+            while (true)
+            {
+                cursor = SkipBlanks(cursor, lineEnd);
+                long long index = 0;
+                std::from_chars_result result = std::from_chars(cursor, lineEnd, index);
+                if (result.ec != std::errc()) break;
 
-                // APPEND TO LIST OF NEW INDICES
-                unsigned int index = std::stoul(indexString) - 1;
-                newIndices.push_back(index);
-            }
+                // EXTRACT FIRST NUMBER (VERTEX INDEX), NEGATIVE INDICES ARE RELATIVE
+                // TO THE VERTICES OF THIS CHUNK UNTIL THE CHUNKS ARE MERGED
+                cursor = SkipToken(result.ptr, lineEnd);
+                bool relative = index < 0;
+                unsigned int vertexIndex = static_cast<unsigned int>(relative ? vertexCount + index : index - 1);
 
-            // TRIANGULAR FACE
-            if (newIndices.size() == 3)
-            {
-                for (int i=0; i<newIndices.size(); ++i)
+                // FAN TRIANGULATE POLYGONS AS THE CORNERS ARRIVE
+                if (corner == 0)
                 {
-                    mesh.indices.push_back(newIndices[i]);
+                    first = vertexIndex;
+                    firstRelative = relative;
                 }
-            }
-            // POLIGONAL FACE MUST BE TRIANGULATED
-            else
-            {
-                std::vector<unsigned int> triangulatedIndices = TriangulatePolygon(newIndices);
-
-                // APPEND TRIANGULATED INDICES TO MODEL
-                for (int i=0; i<triangulatedIndices.size(); ++i)
+                if (corner >= 2)
                 {
-                    mesh.indices.push_back(triangulatedIndices[i]);
+                    if (firstRelative) chunk.relativeIndices.push_back(indices.size());
+                    if (previousRelative) chunk.relativeIndices.push_back(indices.size() + 1);
+                    if (relative) chunk.relativeIndices.push_back(indices.size() + 2);
+                    indices.push_back(first);
+                    indices.push_back(previous);
+                    indices.push_back(vertexIndex);
+
+                    // KEEP THE POLYGON OUTLINE: FAN DIAGONALS ARE NOT POLYGON EDGES
+                    chunk.edgeMasks.push_back(corner == 2 ? 0x3 : 0x2);
                 }
+                previousRelative = relative;
+                previous = vertexIndex;
+                ++corner;
             }
+
+            // LAST FAN TRIANGLE CLOSES THE POLYGON
+            if (corner >= 3) chunk.edgeMasks.back() |= 0x4;
         }
+
+        cursor = lineEnd + 1;
+    }
+}
+
+// SPLIT OBJ TEXT INTO CHUNKS THAT START AFTER A LINE BREAK (RETURNS CHUNK COUNT + 1 BOUNDARIES)
+std::vector<const char*> SplitOBJLines(const char *begin, const char *end, size_t chunkCount)
+{
+    size_t size = static_cast<size_t>(end - begin);
+    std::vector<const char*> boundaries(chunkCount + 1);
+    boundaries[0] = begin;
+    boundaries[chunkCount] = end;
+    for (size_t i=1; i<chunkCount; ++i)
+    {
+        const char *boundary = std::max(begin + size * i / chunkCount, boundaries[i - 1]);
+        while (boundary > begin && boundary < end && boundary[-1] != '\n') ++boundary;
+        boundaries[i] = boundary;
+    }
+    return boundaries;
+}
+
+// SPLIT OBJ TEXT AT LINE BOUNDARIES, PARSE THE CHUNKS IN PARALLEL AND MERGE THEM INTO THE MESH
+void ParseOBJParallel(const char *begin, const char *end, Mesh &mesh)
+{
+    // CHOOSE CHUNK COUNT (SMALL FILES ARE NOT WORTH SPLITTING)
+    const size_t minChunkSize = 1 << 20;
+    size_t size = static_cast<size_t>(end - begin);
+    size_t chunkCount = std::min(size / minChunkSize, static_cast<size_t>(omp_get_max_threads()) * 4);
+    if (chunkCount < 2)
+    {
+        OBJChunk chunk;
+        ParseOBJ(begin, end, chunk);
+        mesh.vertices = std::move(chunk.vertices);
+        mesh.indices = std::move(chunk.indices);
+        mesh.edgeMasks = std::move(chunk.edgeMasks);
+        return;
+    }
+
+
+
+    // CHUNK BOUNDARIES START AFTER THE NEXT LINE BREAK
+    std::vector<const char*> boundaries = SplitOBJLines(begin, end, chunkCount);
+
+
+
+    // PARSE EACH CHUNK ON ITS OWN THREAD
+    std::vector<OBJChunk> chunks(chunkCount);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < static_cast<int>(chunkCount); ++i)
+    {
+        ParseOBJ(boundaries[i], boundaries[i + 1], chunks[i]);
+    }
+
+
+
+    // PREFIX SUM OF VERTEX AND INDEX COUNTS GIVES EACH CHUNK ITS OUTPUT OFFSET
+    std::vector<size_t> vertexOffsets(chunkCount + 1, 0);
+    std::vector<size_t> indexOffsets(chunkCount + 1, 0);
+    for (size_t i=0; i<chunkCount; ++i)
+    {
+        vertexOffsets[i + 1] = vertexOffsets[i] + chunks[i].vertices.size();
+        indexOffsets[i + 1] = indexOffsets[i] + chunks[i].indices.size();
+    }
+    mesh.vertices.resize(vertexOffsets[chunkCount]);
+    mesh.indices.resize(indexOffsets[chunkCount]);
+    mesh.edgeMasks.resize(indexOffsets[chunkCount] / 3);
+    float *vertexOut = mesh.vertices.MutableData();
+    unsigned int *indexOut = mesh.indices.MutableData();
+    unsigned char *edgeMaskOut = mesh.edgeMasks.MutableData();
+
+
+
+    // COPY CHUNKS INTO PLACE, SHIFTING RELATIVE INDICES BY THE VERTICES OF EARLIER CHUNKS
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < static_cast<int>(chunkCount); ++i)
+    {
+        OBJChunk &chunk = chunks[i];
+        unsigned int vertexBase = static_cast<unsigned int>(vertexOffsets[i] / 3);
+        for (size_t slot : chunk.relativeIndices) chunk.indices[slot] += vertexBase;
+
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertexOut + vertexOffsets[i]);
+        std::copy(chunk.indices.begin(), chunk.indices.end(), indexOut + indexOffsets[i]);
+        std::copy(chunk.edgeMasks.begin(), chunk.edgeMasks.end(), edgeMaskOut + indexOffsets[i] / 3);
+        chunk = OBJChunk();
+    }
+}
+
+// AXIS ALIGNED BOUNDS OF ALL MESH VERTICES
+void ComputeBounds(Mesh &mesh)
+{
+    int vertexCount = mesh.VertexCount();
+    if (vertexCount == 0)
+    {
+        mesh.boundsMin = glm::vec3(0.0f);
+        mesh.boundsMax = glm::vec3(0.0f);
+        return;
+    }
+
+    const float *vertices = mesh.vertices.data();
+    float minX = vertices[0], minY = vertices[1], minZ = vertices[2];
+    float maxX = minX, maxY = minY, maxZ = minZ;
+
+    #pragma omp parallel for reduction(min: minX, minY, minZ) reduction(max: maxX, maxY, maxZ)
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        minX = std::min(minX, vertices[i * 3]);
+        minY = std::min(minY, vertices[i * 3 + 1]);
+        minZ = std::min(minZ, vertices[i * 3 + 2]);
+        maxX = std::max(maxX, vertices[i * 3]);
+        maxY = std::max(maxY, vertices[i * 3 + 1]);
+        maxZ = std::max(maxZ, vertices[i * 3 + 2]);
     }
-    
+    mesh.boundsMin = glm::vec3(minX, minY, minZ);
+    mesh.boundsMax = glm::vec3(maxX, maxY, maxZ);
+}
+
+// LOAD OBJ FROM FILE INTO MESH CLASS
+Mesh LoadOBJ(std::string filepath)
+{
+    Mesh mesh;
+    auto start = std::chrono::high_resolution_clock::now();
+
+
+
+    // USE THE BINARY CACHE WHEN IT MATCHES THE SOURCE FILE
+    if (LoadMeshCache(filepath, mesh))
+    {
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        std::cout << "[LoadOBJ] Mapped cache '" << MeshCachePath(filepath) << "' in " << seconds * 1000.0 << " ms" << std::endl;
+        return mesh;
+    }
+    MappedFile file(filepath);
+
+
+
+    // CHECK IF FILEPATH EXISTS
+    if (!file.IsOpen())
+    {
+        std::cerr << "[LoadOBJ] Error: Could not open file '" << filepath << "'" << std::endl;
+        return mesh;
+    }
+
+
+
+    // PARSE THE MAPPED FILE, THEN MERGE THE FACES OF BLOCK WORLDS
+    ParseOBJParallel(file.Data(), file.End(), mesh);
+    ComputeBounds(mesh);
+    if (OptimizeVoxelMesh(mesh)) ComputeBounds(mesh);
+
+
+
+    // REPORT PARSE THROUGHPUT
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    double megabytes = static_cast<double>(file.Size()) / (1024.0 * 1024.0);
+    std::cout << "[LoadOBJ] Loaded '" << filepath << "' (" << megabytes << " MB) in " << seconds * 1000.0 << " ms, "
+              << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s" << std::endl;
 
+    // WRITE THE CACHE FOR THE NEXT LAUNCH
+    SaveMeshCache(filepath, mesh);
 
-    // CLOSE FILE AND RETURN MESH
-    file.close();
     return mesh;
 }
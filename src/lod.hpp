@@ -0,0 +1,485 @@
+#pragma once
+
+#include <cmath>
+#include <queue>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include "mesh.hpp"
+#include "edges.hpp"
+
+// CHUNK SIZE AND PER LEVEL TRIANGLE REDUCTION OF THE LOD CHAIN
+const unsigned int LOD_CHUNK_TRIANGLES = 8192;
+const unsigned int LOD_REDUCTION_SHIFT = 2; // each level keeps about a quarter of the triangles
+
+// SYMMETRIC 4X4 ERROR QUADRIC (GARLAND-HECKBERT): SUM OF SQUARED DISTANCES TO A SET OF PLANES
+struct Quadric
+{
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+
+    void AddPlane(double a, double b, double c, double d)
+    {
+        a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+        b2 += b * b; bc += b * c; bd += b * d;
+        c2 += c * c; cd += c * d;
+        d2 += d * d;
+    }
+
+    void Add(const Quadric &q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+    }
+
+    double Evaluate(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+             + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+             + c2 * z * z + 2.0 * cd * z
+             + d2;
+    }
+};
+
+// SIMPLIFIED LEVELS OF ONE CHUNK: THE FULL RESOLUTION VERTEX IDS EACH LEVEL KEEPS, ITS TRIANGLES (INDEXING
+// THAT LIST) AND ITS ERROR
+struct LODChunkLevels
+{
+    std::vector<unsigned int> vertices[LOD_LEVELS];
+    std::vector<unsigned int> indices[LOD_LEVELS];
+    float error[LOD_LEVELS] = {};
+};
+
+// SIMPLIFY ONE CHUNK BY HALF EDGE COLLAPSES IN ORDER OF QUADRIC ERROR. COLLAPSES ONLY MERGE A VERTEX INTO A
+// NEIGHBOUR, SO EVERY LEVEL USES A SUBSET OF THE ORIGINAL VERTICES. VERTICES ON THE CHUNK BORDER (SHARED),
+// ON OPEN OR NON-MANIFOLD EDGES NEVER MOVE, AND COLLAPSES THAT FLIP A TRIANGLE OR PINCH THE SURFACE ARE SKIPPED.
+void SimplifyLODChunk(const float *vertices, const unsigned int *indices, size_t triangleCount, const std::vector<unsigned char> &sharedVertex, LODChunkLevels &out)
+{
+    // LOCAL VERTEX NUMBERING
+    std::vector<unsigned int> ids(indices, indices + triangleCount * 3);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    auto localId = [&](unsigned int id) { return static_cast<unsigned int>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin()); };
+    size_t vertexCount = ids.size();
+
+    std::vector<glm::vec3> positions(vertexCount);
+    std::vector<unsigned char> locked(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        positions[v] = glm::vec3(vertices[ids[v] * 3], vertices[ids[v] * 3 + 1], vertices[ids[v] * 3 + 2]);
+        locked[v] = sharedVertex[ids[v]];
+    }
+
+
+
+    // TRIANGLES (DEGENERATE ONES DROPPED), VERTEX TO TRIANGLE LISTS AND PLANE QUADRICS
+    std::vector<unsigned int> triangles;
+    triangles.reserve(triangleCount * 3);
+    for (size_t i = 0; i < triangleCount * 3; i += 3)
+    {
+        unsigned int a = localId(indices[i]), b = localId(indices[i + 1]), c = localId(indices[i + 2]);
+        if (a == b || b == c || a == c) continue;
+        triangles.insert(triangles.end(), {a, b, c});
+    }
+    size_t liveTriangles = triangles.size() / 3;
+    std::vector<unsigned char> deadTriangle(liveTriangles, 0);
+    std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < liveTriangles; ++t)
+    {
+        const unsigned int *corners = &triangles[t * 3];
+        glm::dvec3 p1 = positions[corners[0]], p2 = positions[corners[1]], p3 = positions[corners[2]];
+        glm::dvec3 normal = glm::cross(p2 - p1, p3 - p1);
+        double length = glm::length(normal);
+        for (int k = 0; k < 3; ++k) vertexTriangles[corners[k]].push_back(static_cast<unsigned int>(t));
+        if (!(length > 0.0)) continue;
+        normal /= length;
+        for (int k = 0; k < 3; ++k) quadrics[corners[k]].AddPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p1));
+    }
+
+    // LOCK THE ENDS OF EVERY EDGE THAT DOES NOT HAVE EXACTLY TWO TRIANGLES
+    std::vector<uint64_t> edgeKeys;
+    edgeKeys.reserve(triangles.size());
+    for (size_t t = 0; t < liveTriangles; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            uint64_t a = triangles[t * 3 + k], b = triangles[t * 3 + (k + 1) % 3];
+            edgeKeys.push_back(std::min(a, b) << 32 | std::max(a, b));
+        }
+    }
+    std::sort(edgeKeys.begin(), edgeKeys.end());
+    for (size_t i = 0; i < edgeKeys.size();)
+    {
+        size_t j = i;
+        while (j < edgeKeys.size() && edgeKeys[j] == edgeKeys[i]) ++j;
+        if (j - i != 2)
+        {
+            locked[edgeKeys[i] >> 32] = 1;
+            locked[edgeKeys[i] & 0xFFFFFFFF] = 1;
+        }
+        i = j;
+    }
+
+
+
+    // COLLAPSE CANDIDATES IN A MIN HEAP. A CANDIDATE IS STALE ONCE EITHER END HAS CHANGED SINCE IT WAS PUSHED.
+    struct Candidate
+    {
+        double cost;
+        unsigned int from, to, fromStamp, toStamp;
+        bool operator>(const Candidate &other) const { return cost > other.cost; }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    std::vector<unsigned int> stamps(vertexCount, 0);
+    std::vector<unsigned char> deadVertex(vertexCount, 0);
+    std::vector<float> reach(vertexCount, 0.0f); // how far the vertices merged into each vertex have moved
+    auto push = [&](unsigned int from, unsigned int to)
+    {
+        if (locked[from]) return;
+        double cost = quadrics[from].Evaluate(positions[to]) + quadrics[to].Evaluate(positions[to]);
+        heap.push({std::max(cost, 0.0), from, to, stamps[from], stamps[to]});
+    };
+    for (size_t t = 0; t < liveTriangles; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            push(triangles[t * 3 + k], triangles[t * 3 + (k + 1) % 3]);
+            push(triangles[t * 3 + (k + 1) % 3], triangles[t * 3 + k]);
+        }
+    }
+
+    // LIVE NEIGHBOURS OF A VERTEX (DROPS DEAD TRIANGLES FROM ITS LIST ON THE WAY)
+    auto neighbours = [&](unsigned int v, std::vector<unsigned int> &result)
+    {
+        std::vector<unsigned int> &list = vertexTriangles[v];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](unsigned int t) { return deadTriangle[t] != 0; }), list.end());
+        result.clear();
+        for (unsigned int t : list)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                if (triangles[t * 3 + k] != v) result.push_back(triangles[t * 3 + k]);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    };
+
+    std::vector<unsigned int> fromNeighbours, toNeighbours, common;
+    auto canCollapse = [&](unsigned int from, unsigned int to)
+    {
+        // LINK CONDITION: THE ENDS MAY ONLY SHARE THE NEIGHBOURS OPPOSITE THE EDGE
+        neighbours(from, fromNeighbours);
+        neighbours(to, toNeighbours);
+        common.clear();
+        std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(), toNeighbours.begin(), toNeighbours.end(), std::back_inserter(common));
+        size_t edgeTriangles = 0;
+        for (unsigned int t : vertexTriangles[from])
+        {
+            const unsigned int *corners = &triangles[t * 3];
+            if (corners[0] == to || corners[1] == to || corners[2] == to) ++edgeTriangles;
+        }
+        if (edgeTriangles == 0 || common.size() != edgeTriangles) return false;
+
+        // NO REMAINING TRIANGLE MAY FLIP OR COLLAPSE TO A LINE
+        for (unsigned int t : vertexTriangles[from])
+        {
+            const unsigned int *corners = &triangles[t * 3];
+            if (corners[0] == to || corners[1] == to || corners[2] == to) continue;
+            glm::vec3 before[3], after[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                before[k] = positions[corners[k]];
+                after[k] = corners[k] == from ? positions[to] : before[k];
+            }
+            glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (!(glm::dot(normalBefore, normalAfter) > 0.0f)) return false;
+        }
+        return true;
+    };
+
+    auto collapse = [&](unsigned int from, unsigned int to)
+    {
+        for (unsigned int t : vertexTriangles[from])
+        {
+            unsigned int *corners = &triangles[t * 3];
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+            {
+                deadTriangle[t] = 1;
+                --liveTriangles;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                if (corners[k] == from) corners[k] = to;
+            }
+            vertexTriangles[to].push_back(t);
+        }
+        vertexTriangles[from].clear();
+        quadrics[to].Add(quadrics[from]);
+        reach[to] = std::max(reach[to], reach[from] + glm::length(positions[to] - positions[from]));
+        deadVertex[from] = 1;
+        ++stamps[to];
+
+        neighbours(to, toNeighbours);
+        for (unsigned int w : toNeighbours)
+        {
+            push(w, to);
+            push(to, w);
+        }
+    };
+
+
+
+    // COLLAPSE DOWN TO EACH LEVEL'S TARGET AND TAKE A SNAPSHOT OF THE SURVIVING TRIANGLES. THE LEVEL ERROR IS
+    // THE LARGER OF THE SURFACE DEVIATION AND HOW FAR ANY LINE END MOVED: A WIREFRAME SHOWS COLLAPSES INSIDE
+    // FLAT AREAS TOO, SO THOSE MUST ALSO SHRINK BELOW THE PIXEL BUDGET.
+    double maxCost = 0.0;
+    float maxReach = 0.0f;
+    size_t target = triangleCount;
+    std::vector<unsigned int> remap(vertexCount);
+    for (int level = 1; level < LOD_LEVELS; ++level)
+    {
+        target >>= LOD_REDUCTION_SHIFT;
+        while (liveTriangles > target && !heap.empty())
+        {
+            Candidate candidate = heap.top();
+            heap.pop();
+            if (deadVertex[candidate.from] || deadVertex[candidate.to]) continue;
+            if (candidate.fromStamp != stamps[candidate.from] || candidate.toStamp != stamps[candidate.to]) continue;
+            if (!canCollapse(candidate.from, candidate.to)) continue;
+            collapse(candidate.from, candidate.to);
+            maxCost = std::max(maxCost, candidate.cost);
+            maxReach = std::max(maxReach, reach[candidate.to]);
+        }
+
+        std::vector<unsigned int> &levelVertices = out.vertices[level];
+        std::vector<unsigned int> &levelIndices = out.indices[level];
+        std::fill(remap.begin(), remap.end(), 0xFFFFFFFF);
+        for (size_t t = 0; t < deadTriangle.size(); ++t)
+        {
+            if (deadTriangle[t]) continue;
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int v = triangles[t * 3 + k];
+                if (remap[v] == 0xFFFFFFFF)
+                {
+                    remap[v] = static_cast<unsigned int>(levelVertices.size());
+                    levelVertices.push_back(ids[v]);
+                }
+                levelIndices.push_back(remap[v]);
+            }
+        }
+        out.error[level] = std::max(static_cast<float>(std::sqrt(maxCost)), maxReach);
+    }
+}
+
+// SPLIT THE MESH INTO CHUNKS (THE LARGEST BVH SUBTREES WITH AT MOST LOD_CHUNK_TRIANGLES TRIANGLES) AND
+// SIMPLIFY THEM IN PARALLEL INTO THE LOD LEVELS. RUN AFTER BuildBVH.
+void BuildLODs(Mesh &mesh)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    mesh.lodChunks.clear();
+    mesh.lods.clear();
+    if (mesh.bvh.empty()) return;
+    for (BVHNode &node : mesh.bvh) node.lodChunk = NO_LOD_CHUNK;
+
+    std::vector<unsigned int> stack = {0};
+    while (!stack.empty())
+    {
+        unsigned int n = stack.back();
+        stack.pop_back();
+        BVHNode &node = mesh.bvh[n];
+        if (node.triangleCount <= LOD_CHUNK_TRIANGLES || node.rightChild == 0)
+        {
+            node.lodChunk = static_cast<unsigned int>(mesh.lodChunks.size());
+            LODChunk chunk = {};
+            chunk.node = n;
+            mesh.lodChunks.push_back(chunk);
+            continue;
+        }
+        stack.push_back(node.rightChild);
+        stack.push_back(n + 1);
+    }
+
+
+
+    // VERTICES USED BY MORE THAN ONE CHUNK FORM THE BORDERS AND STAY IN PLACE
+    size_t vertexCount = mesh.vertices.size() / 3;
+    std::vector<unsigned int> owner(vertexCount, NO_LOD_CHUNK);
+    std::vector<unsigned char> sharedVertex(vertexCount, 0);
+    const unsigned int *indices = mesh.indices.data();
+    for (size_t c = 0; c < mesh.lodChunks.size(); ++c)
+    {
+        const BVHNode &node = mesh.bvh[mesh.lodChunks[c].node];
+        for (size_t i = node.firstTriangle * size_t(3); i < (node.firstTriangle + size_t(node.triangleCount)) * 3; ++i)
+        {
+            unsigned int &vertexOwner = owner[indices[i]];
+            if (vertexOwner == NO_LOD_CHUNK) vertexOwner = static_cast<unsigned int>(c);
+            else if (vertexOwner != c) sharedVertex[indices[i]] = 1;
+        }
+    }
+
+    std::vector<LODChunkLevels> levels(mesh.lodChunks.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long c = 0; c < static_cast<long long>(levels.size()); ++c)
+    {
+        const BVHNode &node = mesh.bvh[mesh.lodChunks[c].node];
+        SimplifyLODChunk(mesh.vertices.data(), indices + node.firstTriangle * size_t(3), node.triangleCount, sharedVertex, levels[c]);
+    }
+
+
+
+    // CONCATENATE THE CHUNKS OF EACH LEVEL
+    mesh.lods.resize(LOD_LEVELS - 1);
+    for (int level = 1; level < LOD_LEVELS; ++level)
+    {
+        std::vector<float> levelVertices;
+        std::vector<unsigned int> levelIndices;
+        for (size_t c = 0; c < levels.size(); ++c)
+        {
+            LODChunk &chunk = mesh.lodChunks[c];
+            unsigned int firstVertex = static_cast<unsigned int>(levelVertices.size() / 3);
+            chunk.firstVertex[level] = firstVertex;
+            chunk.vertexCount[level] = static_cast<unsigned int>(levels[c].vertices[level].size());
+            chunk.firstTriangle[level] = static_cast<unsigned int>(levelIndices.size() / 3);
+            chunk.triangleCount[level] = static_cast<unsigned int>(levels[c].indices[level].size() / 3);
+            chunk.error[level] = levels[c].error[level];
+            for (unsigned int id : levels[c].vertices[level])
+            {
+                levelVertices.insert(levelVertices.end(), mesh.vertices.data() + id * size_t(3), mesh.vertices.data() + id * size_t(3) + 3);
+            }
+            for (unsigned int index : levels[c].indices[level]) levelIndices.push_back(firstVertex + index);
+        }
+        mesh.lods[level - 1].vertices = MeshBuffer<float>(std::move(levelVertices));
+        mesh.lods[level - 1].indices = MeshBuffer<unsigned int>(std::move(levelIndices));
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "[BuildLODs] " << mesh.lodChunks.size() << " chunks, triangles per level:";
+    std::cout << " " << mesh.TriangleCount();
+    for (const MeshLOD &lod : mesh.lods) std::cout << " " << lod.TriangleCount();
+    std::cout << " in " << milliseconds << " ms" << std::endl;
+}
+
+// BUILD WHAT THE RENDERER NEEDS FROM THE LOD LEVELS (BUILT OR LOADED FROM THE CACHE): PER CHUNK EDGE LISTS
+// WITHOUT EDGES INSIDE FLAT AREAS, SOA VERTICES, FACE PLANES, AND THE FULL RESOLUTION EDGES CROSSING CHUNK
+// BORDERS. RUN AFTER BuildMeshlets (WHICH REORDERS THE EDGES).
+void PrepareLODs(Mesh &mesh)
+{
+    mesh.lodBorderEdges.clear();
+    mesh.lodBorderStarts.clear();
+    mesh.lodBorderVertices.clear();
+    size_t chunkCount = mesh.lodChunks.size();
+    if (chunkCount == 0) return;
+
+    for (size_t l = 0; l < mesh.lods.size(); ++l)
+    {
+        MeshLOD &lod = mesh.lods[l];
+        int level = static_cast<int>(l) + 1;
+        BuildVertexStreams(lod.vertices.data(), lod.VertexCount(), lod.vertexStreams);
+        BuildFacePlanes(lod.vertices.data(), lod.indices.data(), lod.TriangleCount(), lod.facePlanes);
+
+        std::vector<std::vector<MeshEdge>> chunkEdges(chunkCount);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (long long c = 0; c < static_cast<long long>(chunkCount); ++c)
+        {
+            const LODChunk &chunk = mesh.lodChunks[c];
+            std::vector<MeshEdge> &edges = chunkEdges[c];
+            const unsigned int *chunkIndices = lod.indices.data() + chunk.firstTriangle[level] * size_t(3);
+            std::vector<unsigned int> localIndices(chunkIndices, chunkIndices + chunk.triangleCount[level] * size_t(3));
+            for (unsigned int &index : localIndices) index -= chunk.firstVertex[level];
+            BuildEdgeList(lod.vertices.data() + chunk.firstVertex[level] * size_t(3), chunk.vertexCount[level], localIndices.data(), nullptr, chunk.triangleCount[level], edges);
+            for (MeshEdge &edge : edges)
+            {
+                edge.v0 += chunk.firstVertex[level];
+                edge.v1 += chunk.firstVertex[level];
+                edge.face0 += chunk.firstTriangle[level];
+                if (edge.face1 != NO_FACE) edge.face1 += chunk.firstTriangle[level];
+            }
+            RemoveCoplanarEdges(lod.vertices.data(), lod.indices.data(), edges);
+        }
+
+        lod.edges.clear();
+        lod.chunkEdges.assign(1, 0);
+        for (const std::vector<MeshEdge> &edges : chunkEdges)
+        {
+            lod.edges.insert(lod.edges.end(), edges.begin(), edges.end());
+            lod.chunkEdges.push_back(static_cast<unsigned int>(lod.edges.size()));
+        }
+    }
+
+
+
+    // FULL RESOLUTION EDGES ARE OWNED BY THEIR FACE0 CHUNK. WHEN THAT CHUNK IS DRAWN COARSER, THE FACE1 SIDE
+    // STILL NEEDS THEM, SO LIST THEM PER BVH LEAF OF FACE1 (WHOSE VERTICES ARE TRANSFORMED WHENEVER IT IS VISIBLE).
+    // CHUNK AND LEAF TRIANGLE RANGES ARE BOTH IN ORDER.
+    std::vector<unsigned int> chunkStarts(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) chunkStarts[c] = mesh.bvh[mesh.lodChunks[c].node].firstTriangle;
+    std::vector<unsigned int> leafStarts;
+    std::vector<unsigned int> leafNodes;
+    for (size_t n = 0; n < mesh.bvh.size(); ++n)
+    {
+        if (mesh.bvh[n].rightChild != 0) continue;
+        leafStarts.push_back(mesh.bvh[n].firstTriangle);
+        leafNodes.push_back(static_cast<unsigned int>(n));
+    }
+    auto rangeOf = [](const std::vector<unsigned int> &starts, unsigned int face)
+    {
+        return static_cast<unsigned int>(std::upper_bound(starts.begin(), starts.end(), face) - starts.begin() - 1);
+    };
+
+    size_t nodeCount = mesh.bvh.size();
+    mesh.lodBorderStarts.assign(nodeCount + 1, 0);
+    std::vector<unsigned int> edgeLeaf(mesh.edges.size(), NO_LOD_CHUNK);
+    for (size_t e = 0; e < mesh.edges.size(); ++e)
+    {
+        const MeshEdge &edge = mesh.edges[e];
+        if (edge.face1 == NO_FACE || rangeOf(chunkStarts, edge.face1) == rangeOf(chunkStarts, edge.face0)) continue;
+        edgeLeaf[e] = leafNodes[rangeOf(leafStarts, edge.face1)];
+        ++mesh.lodBorderStarts[edgeLeaf[e] + 1];
+    }
+    for (size_t n = 0; n < nodeCount; ++n) mesh.lodBorderStarts[n + 1] += mesh.lodBorderStarts[n];
+    mesh.lodBorderEdges.resize(mesh.lodBorderStarts[nodeCount]);
+    std::vector<unsigned int> cursors(mesh.lodBorderStarts.begin(), mesh.lodBorderStarts.end() - 1);
+    for (size_t e = 0; e < mesh.edges.size(); ++e)
+    {
+        if (edgeLeaf[e] != NO_LOD_CHUNK) mesh.lodBorderEdges[cursors[edgeLeaf[e]]++] = static_cast<unsigned int>(e);
+    }
+
+    // THE EDGE'S ENDS ARE FACE0'S VERTICES, WHICH ARE NOT TRANSFORMED WHILE FACE0'S CHUNK IS SIMPLIFIED. WHEN
+    // DUPLICATED VERTICES WERE WELDED, FACE1 HAS ITS OWN COPIES: USE THE CORNERS OF FACE1 AT THE SAME POSITIONS.
+    const float *vertices = mesh.vertices.data();
+    const unsigned int *indices = mesh.indices.data();
+    mesh.lodBorderVertices.resize(mesh.lodBorderEdges.size() * 2);
+    #pragma omp parallel for
+    for (long long i = 0; i < static_cast<long long>(mesh.lodBorderEdges.size()); ++i)
+    {
+        const MeshEdge &edge = mesh.edges[mesh.lodBorderEdges[i]];
+        const unsigned int *corners = indices + edge.face1 * size_t(3);
+        unsigned int ends[2] = {edge.v0, edge.v1};
+        for (unsigned int &end : ends)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int corner = corners[k];
+                if (vertices[corner * 3] == vertices[end * 3] && vertices[corner * 3 + 1] == vertices[end * 3 + 1] && vertices[corner * 3 + 2] == vertices[end * 3 + 2])
+                {
+                    end = corner;
+                    break;
+                }
+            }
+        }
+        mesh.lodBorderVertices[i * 2] = ends[0];
+        mesh.lodBorderVertices[i * 2 + 1] = ends[1];
+    }
+}
@@ -1,11 +1,32 @@
-#include <SFML/Graphics.hpp>
+// BUILD WITH -DWIREFRAME_HEADLESS FOR A BINARY WITHOUT THE WINDOW THAT NEEDS NO SFML (OR DISPLAY) AT ALL,
+// IT ONLY RENDERS TO FILES AND STREAMS (SEE COMPILE_HEADLESS.SH)
+#ifndef WIREFRAME_HEADLESS
+    #include <SFML/Graphics.hpp>
+    #include "Input.h"
+#endif
+#include <string>
+#include <vector>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 #include <omp.h>
-#include "Input.h"
 #include "mesh.hpp"
 #include "loader.hpp"
+#include "stream_loader.hpp"
+#include "edges.hpp"
+#include "bvh.hpp"
+#include "meshlets.hpp"
+#include "lod.hpp"
+#include "mesh_prepare.hpp"
 #include "RenderSystem.hpp"
+#ifdef WIREFRAME_COUNT_ALLOCATIONS
+    #include "alloc_counter.hpp"
+#endif
+#include "image_writer.hpp"
+#include "batch_render.hpp"
+#include "video_stream.hpp"
 #include "../libs/glm/glm.hpp"
 
 struct GLOBAL
@@ -13,19 +34,55 @@ struct GLOBAL
     int WIDTH = 800;
     int HEIGHT = 600;
     float FRAME_TIME;
+#ifdef WIREFRAME_COUNT_ALLOCATIONS
+    size_t FRAME_ALLOCATIONS = 0; // heap allocations of the last frame (0 in steady state)
+#endif
+    bool STREAM_LOAD = true; // draw the mesh while it is still loading
+};
+
+// COMMAND LINE: APPLICATION [MODEL.OBJ] [--size WxH] [--position X,Y,Z] [--rotation PITCH,YAW,ROLL]
+// [--outline] [--out FRAME.PNG|FRAME.PPM]. WITH --out ONE FRAME IS RENDERED HEADLESS AND WRITTEN. WITH
+// --path KEYS.TXT --frames N A WHOLE CAMERA PATH IS, --out IS THEN A PATTERN LIKE FRAME_%04d.PNG, OR WITH
+// --stream y4m|rgb24 [--fps N] THE FRAMES ARE STREAMED TO --out (A FILE OR PIPE, STDOUT BY DEFAULT).
+struct Options
+{
+    std::string modelPath = "./models/minecraft.obj";
+    std::string outputPath;
+    std::string cameraPath;
+    int frameCount = 0;
+    int streamFormat = -1; // VIDEO_FORMAT_*, -1 WRITES IMAGE FILES
+    int framesPerSecond = 30;
+    glm::vec3 position = {2.0f, 28.0f, 8.0f};
+    glm::vec3 rotation = {0.0f, 0.0f, 0.0f};
+    bool outline = false;
 };
 
 // GLOBAL VARIABLES
 GLOBAL global;
-sf::RenderWindow window(sf::VideoMode(global.WIDTH, global.HEIGHT), "Wireframe Engine");    
-InputSystem Input{&window};
 Camera camera;        
-sf::Image renderImage; 
+Framebuffer framebuffer; 
+RenderContext renderContext;
+
+
+
+#ifndef WIREFRAME_HEADLESS
+// WINDOW, INPUT AND THE TEXTURE THE FRAMEBUFFER IS SHOWN THROUGH. ONLY CREATED IN WINDOWED MODE, SFML
+// OPENS THE DISPLAY AS SOON AS ANY OF THEM IS CONSTRUCTED.
+struct Viewer
+{
+    sf::RenderWindow window{sf::VideoMode(global.WIDTH, global.HEIGHT), "Wireframe Engine"};
+    InputSystem Input{&window};
+    sf::Texture texture;
+    sf::Sprite sprite;
+};
 
 
 
-void ProcessInput() 
+void ProcessInput(Viewer &viewer) 
 {
+    sf::RenderWindow &window = viewer.window;
+    InputSystem &Input = viewer.Input;
+
     // CLEAR INPUT SYSTEM STATE
     Input.NewFrame();
 
@@ -63,29 +120,142 @@ void ProcessInput()
     // UPDATE INPUT SYSTEM STATE
     Input.UpdateKeyStates();
 }
+#endif
 
-void Init()
+void Init(const Options &options)
 {
-    // INITIALISE MOUSE CURSOR 
-    window.setMouseCursorVisible(true);
-    Input.ShowMouse();
-
-    // INITIALISE RENDER IMAGE
-    renderImage.create(global.WIDTH, global.HEIGHT, sf::Color::Black); 
+    // INITIALISE FRAMEBUFFER
+    framebuffer.Resize(global.WIDTH, global.HEIGHT); 
 
     // INITIALISE CAMERA
     camera.SetViewport(global.WIDTH, global.HEIGHT);
-    camera.position = {2.0f, 28.0f, 8.0f};
+    camera.position = options.position;
+    camera.rotation = options.rotation;
     camera.UpdateProjectionView(); 
+    renderContext.edgeMode = options.outline ? EDGE_MODE_OUTLINE : EDGE_MODE_ALL;
 }
 
-int main() {
+#ifndef WIREFRAME_HEADLESS
+void InitViewer(Viewer &viewer)
+{
+    // INITIALISE MOUSE CURSOR 
+    viewer.window.setMouseCursorVisible(true);
+    viewer.Input.ShowMouse();
 
-    // INITIALIZE
-    Init();
+    // INITIALISE THE TEXTURE THE FRAMEBUFFER IS UPLOADED TO
+    viewer.texture.create(global.WIDTH, global.HEIGHT);
+    viewer.sprite.setTexture(viewer.texture, true);
+}
+#endif
 
-    // LOAD OBJ AS MESH
-    Mesh mesh = LoadOBJ("./models/minecraft.obj");
+void PrintUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [model.obj] [--size WxH] [--position x,y,z] [--rotation pitch,yaw,roll] [--outline] [--out frame.png|frame.ppm]\n"
+              << "       " << program << " [model.obj] [--size WxH] [--outline] --path keys.txt --frames N --out frame_%04d.png\n"
+              << "       " << program << " [model.obj] [--size WxH] [--outline] --path keys.txt --frames N --stream y4m|rgb24 [--fps N] [--out -|file]" << std::endl;
+}
+
+// PARSE THE COMMAND LINE INTO OPTIONS, FALSE (AFTER PRINTING THE USAGE) ON ANYTHING UNKNOWN
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool valid = true;
+        if (argument == "--size") valid = value && std::sscanf(value, "%dx%d", &global.WIDTH, &global.HEIGHT) == 2 && global.WIDTH > 0 && global.HEIGHT > 0;
+        else if (argument == "--position") valid = value && std::sscanf(value, "%f,%f,%f", &options.position.x, &options.position.y, &options.position.z) == 3;
+        else if (argument == "--rotation") valid = value && std::sscanf(value, "%f,%f,%f", &options.rotation.x, &options.rotation.y, &options.rotation.z) == 3;
+        else if (argument == "--out") valid = value != nullptr;
+        else if (argument == "--path") valid = value != nullptr;
+        else if (argument == "--frames") valid = value && std::sscanf(value, "%d", &options.frameCount) == 1 && options.frameCount > 0;
+        else if (argument == "--fps") valid = value && std::sscanf(value, "%d", &options.framesPerSecond) == 1 && options.framesPerSecond > 0;
+        else if (argument == "--stream")
+        {
+            std::string format = value ? value : "";
+            options.streamFormat = format == "y4m" ? VIDEO_FORMAT_Y4M : format == "rgb24" ? VIDEO_FORMAT_RGB24 : -1;
+            valid = options.streamFormat != -1;
+        }
+        else if (argument == "--outline") options.outline = true;
+        else if (argument.compare(0, 2, "--") != 0) options.modelPath = argument;
+        else valid = false;
+
+        if (!valid)
+        {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        if (argument == "--out") options.outputPath = value;
+        if (argument == "--path") options.cameraPath = value;
+        if (argument == "--size" || argument == "--position" || argument == "--rotation" || argument == "--out" || argument == "--path" ||
+            argument == "--frames" || argument == "--fps" || argument == "--stream") ++i;
+    }
+
+    // A CAMERA PATH NEEDS A FRAME COUNT AND A FILE NAME PATTERN WITH ONE %d (OR A STREAM, TO STDOUT UNLESS GIVEN)
+    bool streaming = options.streamFormat != -1;
+    if (streaming && options.outputPath.empty()) options.outputPath = "-";
+    if ((streaming && options.cameraPath.empty()) ||
+        (!options.cameraPath.empty() && (options.frameCount == 0 || (!streaming && !ValidFramePattern(options.outputPath)))))
+    {
+        PrintUsage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+// RENDER ONE FRAME WITHOUT A WINDOW AND WRITE IT TO OPTIONS.OUTPUTPATH
+int RunHeadless(const Options &options)
+{
+    Mesh mesh = LoadOBJ(options.modelPath);
+    if (mesh.TriangleCount() == 0) return EXIT_FAILURE;
+    PrepareMesh(mesh, options.modelPath);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    framebuffer.Clear(PIXEL_BLACK);
+    DrawWireframe(mesh, camera, framebuffer, renderContext);
+    auto end = std::chrono::high_resolution_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    if (!WriteImage(options.outputPath, framebuffer)) return EXIT_FAILURE;
+    std::cout << "[Headless] Rendered " << framebuffer.width << "x" << framebuffer.height << " in " << milliseconds << " ms to '" << options.outputPath << "'" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// RENDER A CAMERA PATH WITHOUT A WINDOW, ONE FRAME PER THREAD AT A TIME, OR STREAM IT IN ORDER
+int RunBatch(const Options &options)
+{
+    std::vector<CameraKey> keys;
+    if (!LoadCameraPath(options.cameraPath, keys)) return EXIT_FAILURE;
+    Mesh mesh = LoadOBJ(options.modelPath);
+    if (mesh.TriangleCount() == 0) return EXIT_FAILURE;
+    PrepareMesh(mesh, options.modelPath);
+    if (options.streamFormat != -1)
+    {
+        bool streamed = StreamCameraPath(mesh, keys, options.frameCount, global.WIDTH, global.HEIGHT, renderContext.edgeMode, options.outputPath, options.streamFormat, options.framesPerSecond);
+        return streamed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    bool written = RenderCameraPath(mesh, keys, options.frameCount, global.WIDTH, global.HEIGHT, renderContext.edgeMode, options.outputPath);
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#ifndef WIREFRAME_HEADLESS
+int RunWindow(const Options &options)
+{
+    Viewer viewer;
+    sf::RenderWindow &window = viewer.window;
+    InputSystem &Input = viewer.Input;
+    InitViewer(viewer);
+
+    // LOAD OBJ AS MESH (STREAMED IN THE BACKGROUND OR BEFORE THE FIRST FRAME)
+    const std::string &modelPath = options.modelPath;
+    OBJStream meshStream;
+    Mesh mesh;
+    if (global.STREAM_LOAD) meshStream.Start(modelPath);
+    else
+    {
+        mesh = LoadOBJ(modelPath);
+        PrepareMesh(mesh, modelPath);
+    }
 
 
 
@@ -94,10 +264,23 @@ int main() {
     while (window.isOpen()) 
     {
         auto start = std::chrono::high_resolution_clock::now();
-        ProcessInput();
+#ifdef WIREFRAME_COUNT_ALLOCATIONS
+        size_t allocationsBefore = HeapAllocationCount();
+#endif
+        ProcessInput(viewer);
 
-        // CLEAR RENDER TARGET
-        renderImage.create(global.WIDTH, global.HEIGHT, sf::Color::Black);
+        // PICK UP ANY NEWLY LOADED GEOMETRY (THE COMPLETE MESH ARRIVES PREPARED)
+        meshStream.Poll(mesh);
+
+        // CLEAR RENDER TARGET (ONLY THE TILES DRAWN LAST FRAME; THE FRAMEBUFFER AND TEXTURE ARE ONLY
+        // REALLOCATED WHEN THE WINDOW SIZE CHANGES)
+        if (framebuffer.width != global.WIDTH || framebuffer.height != global.HEIGHT)
+        {
+            framebuffer.Resize(global.WIDTH, global.HEIGHT);
+            viewer.texture.create(global.WIDTH, global.HEIGHT);
+            viewer.sprite.setTexture(viewer.texture, true);
+        }
+        framebuffer.Clear(PIXEL_BLACK);
 
         // TOGGLE MOUSE
         if (Input.GetKeyDown(KeyCode::Escape))
@@ -116,6 +299,12 @@ int main() {
             }
         }
 
+        // TOGGLE OUTLINE MODE (SILHOUETTES, CREASES AND BOUNDARIES ONLY)
+        if (Input.GetKeyDown(KeyCode::F))
+        {
+            renderContext.edgeMode = renderContext.edgeMode == EDGE_MODE_ALL ? EDGE_MODE_OUTLINE : EDGE_MODE_ALL;
+        }
+
         // BASIC CAMERA MOVEMENT
         if (Input.GetKey(KeyCode::W)) camera.position += 6.5f * camera.Forward() * global.FRAME_TIME;
         if (Input.GetKey(KeyCode::A)) camera.position -= 6.5f * camera.Right() * global.FRAME_TIME;
@@ -137,26 +326,56 @@ int main() {
         camera.UpdateProjectionView(); 
 
         // RENDER MESH AS WIREFRAME (RENDER PIPELINE)
-        DrawWireframe(mesh, camera, renderImage);
-
-        // CREATE SPRITE FROM RENDER IMAGE
-        sf::Texture texture;
-        sf::Sprite sprite;
-        texture.loadFromImage(renderImage);
-        sprite.setTexture(texture);
-        
+        DrawWireframe(mesh, camera, framebuffer, renderContext);
+
+        // UPLOAD THE TILES DRAWN OR CLEARED THIS FRAME INTO THE PERSISTENT TEXTURE
+        framebuffer.ForEachChangedRect([&](int x, int y, int w, int h)
+        {
+            viewer.texture.update(framebuffer.PackRect(x, y, w, h), w, h, x, y);
+        });
+
         // WINDOW DRAW SPRITE
         window.clear();
-        window.draw(sprite);
+        window.draw(viewer.sprite);
         window.display();
 
         // FRAME TIME CALCULATION
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
         global.FRAME_TIME = duration.count();
+
+#ifdef WIREFRAME_COUNT_ALLOCATIONS
+        // REPORT WHEN THE NUMBER OF HEAP ALLOCATIONS PER FRAME CHANGES (E.G. BUFFERS GROWING FOR A NEW VIEW)
+        size_t allocations = HeapAllocationCount() - allocationsBefore;
+        if (allocations != global.FRAME_ALLOCATIONS) std::cout << "[Frame] " << allocations << " heap allocations" << std::endl;
+        global.FRAME_ALLOCATIONS = allocations;
+#endif
     }
 
 
 
     return EXIT_SUCCESS;
 }
+#endif
+
+int main(int argc, char **argv) {
+
+    // INITIALIZE
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+    Init(options);
+
+    // FRAMES STREAMED TO STDOUT OWN IT, THE LOG GOES TO STDERR
+    if (options.streamFormat != -1 && options.outputPath == "-") std::cout.rdbuf(std::cerr.rdbuf());
+
+    // WITH AN OUTPUT PATH NO WINDOW IS EVER OPENED
+    if (!options.cameraPath.empty()) return RunBatch(options);
+    if (!options.outputPath.empty()) return RunHeadless(options);
+#ifdef WIREFRAME_HEADLESS
+    std::cerr << "[Main] Error: Built without a window, give --out or --path" << std::endl;
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+#else
+    return RunWindow(options);
+#endif
+}
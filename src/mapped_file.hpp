@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+// READ-ONLY VIEW OF A WHOLE FILE MAPPED INTO MEMORY (UNMAPPED ON DESTRUCTION)
+class MappedFile
+{
+public:
+    MappedFile() {}
+
+    explicit MappedFile(const std::string &filepath)
+    {
+        Open(filepath);
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string &filepath)
+    {
+        Close();
+
+#ifdef _WIN32
+        fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize))
+        {
+            Close();
+            return false;
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        isOpen = true;
+
+        // EMPTY FILES CANNOT BE MAPPED, BUT ARE STILL VALID
+        if (size == 0) return true;
+
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr)
+        {
+            Close();
+            return false;
+        }
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        fileDescriptor = open(filepath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) return false;
+
+        struct stat fileStat;
+        if (fstat(fileDescriptor, &fileStat) != 0)
+        {
+            Close();
+            return false;
+        }
+        size = static_cast<size_t>(fileStat.st_size);
+        isOpen = true;
+
+        // EMPTY FILES CANNOT BE MAPPED, BUT ARE STILL VALID
+        if (size == 0) return true;
+
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            Close();
+            return false;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+#endif
+
+        if (data == nullptr)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (data != nullptr) UnmapViewOfFile(data);
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (data != nullptr) munmap(const_cast<char*>(data), size);
+        if (fileDescriptor >= 0) close(fileDescriptor);
+        fileDescriptor = -1;
+#endif
+        data = nullptr;
+        size = 0;
+        isOpen = false;
+    }
+
+    bool IsOpen() const { return isOpen; }
+    const char* Data() const { return data; }
+    const char* End() const { return data + size; }
+    size_t Size() const { return size; }
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+    bool isOpen = false;
+
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
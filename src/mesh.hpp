@@ -1,14 +1,194 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
 #include "../libs/glm/glm.hpp"
+#include "vertex_streams.hpp"
+#include "face_planes.hpp"
+
+// CONTIGUOUS ARRAY THAT EITHER OWNS ITS ELEMENTS OR VIEWS MEMORY KEPT ALIVE BY A SHARED OWNER
+// (E.G. A MAPPED CACHE FILE). MODIFYING A VIEW COPIES IT INTO OWNED STORAGE FIRST.
+template <typename T>
+class MeshBuffer
+{
+public:
+    MeshBuffer() {}
+    MeshBuffer(std::vector<T> &&values) : storage(std::move(values)) { Refresh(); }
+    MeshBuffer(const MeshBuffer &other) : storage(other.storage), owner(other.owner), elements(other.elements), count(other.count) { Refresh(); }
+    MeshBuffer(MeshBuffer &&other) noexcept : storage(std::move(other.storage)), owner(std::move(other.owner)), elements(other.elements), count(other.count) { Refresh(); other.Reset(); }
+
+    MeshBuffer& operator=(const MeshBuffer &other)
+    {
+        if (this == &other) return *this;
+        storage = other.storage;
+        owner = other.owner;
+        elements = other.elements;
+        count = other.count;
+        Refresh();
+        return *this;
+    }
+
+    MeshBuffer& operator=(MeshBuffer &&other) noexcept
+    {
+        if (this == &other) return *this;
+        storage = std::move(other.storage);
+        owner = std::move(other.owner);
+        elements = other.elements;
+        count = other.count;
+        Refresh();
+        other.Reset();
+        return *this;
+    }
+
+    // WRAP EXTERNAL MEMORY WITHOUT COPYING IT
+    static MeshBuffer View(std::shared_ptr<const void> owner, const T *elements, size_t count)
+    {
+        MeshBuffer buffer;
+        buffer.owner = std::move(owner);
+        buffer.elements = const_cast<T*>(elements);
+        buffer.count = count;
+        return buffer;
+    }
+
+    bool IsView() const { return owner != nullptr; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* data() const { return elements; }
+    const T* begin() const { return elements; }
+    const T* end() const { return elements + count; }
+    const T& operator[](size_t i) const { return elements[i]; }
+
+    // WRITE ACCESS DETACHES VIEWS
+    T* MutableData() { Detach(); return elements; }
+
+    void push_back(const T &value) { Detach(); storage.push_back(value); Refresh(); }
+    void reserve(size_t n) { Detach(); storage.reserve(n); Refresh(); }
+    void resize(size_t n) { Detach(); storage.resize(n); Refresh(); }
+    void clear() { Reset(); }
+
+private:
+    std::vector<T> storage;
+    std::shared_ptr<const void> owner;
+    T *elements = nullptr;
+    size_t count = 0;
+
+    void Detach()
+    {
+        if (owner == nullptr) return;
+        storage.assign(elements, elements + count);
+        owner.reset();
+        Refresh();
+    }
+
+    void Refresh()
+    {
+        if (owner != nullptr) return;
+        elements = storage.data();
+        count = storage.size();
+    }
+
+    void Reset()
+    {
+        storage.clear();
+        owner.reset();
+        elements = nullptr;
+        count = 0;
+    }
+};
+
+// UNDIRECTED EDGE WITH THE (UP TO) TWO TRIANGLES THAT SHARE IT
+const unsigned int NO_FACE = 0xFFFFFFFF;
+
+struct MeshEdge
+{
+    unsigned int v0;
+    unsigned int v1;
+    unsigned int face0;
+    unsigned int face1; // NO_FACE FOR BOUNDARY EDGES
+};
+
+const unsigned int NO_LOD_CHUNK = 0xFFFFFFFF;
+
+// BVH NODE IN DEPTH FIRST ORDER: THE LEFT CHILD FOLLOWS ITS PARENT, LEAVES HAVE RIGHTCHILD = 0.
+// TRIANGLES ARE STORED IN LEAF ORDER SO EVERY NODE COVERS CONTIGUOUS TRIANGLE, VERTEX AND EDGE RANGES.
+struct BVHNode
+{
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    unsigned int rightChild;
+    unsigned int firstTriangle;
+    unsigned int triangleCount;
+    unsigned int vertexBegin; // [begin, end) covers every vertex the node's triangles use
+    unsigned int vertexEnd;
+    unsigned int edgeBegin;   // [begin, end) edges whose face0 lies in the node
+    unsigned int edgeEnd;
+    unsigned int meshlet;     // leaves: index into Mesh::meshlets
+    unsigned int lodChunk;    // LOD chunk rooted at this node, or NO_LOD_CHUNK
+};
+
+// CLUSTER OF THE TRIANGLES IN ONE BVH LEAF WITH A BOUNDING SPHERE AND A CONE BOUNDING THEIR NORMALS.
+// EVERY TRIANGLE IS BACK FACING FROM P WHEN DOT(CENTER - P, AXIS) >= CUTOFF * (|CENTER - P| + RADIUS) + RADIUS.
+struct Meshlet
+{
+    glm::vec3 center;
+    float radius;
+    glm::vec3 coneAxis;
+    float coneCutoff;         // sine of the cone half angle, 1 when the cluster is never back facing as a whole
+    unsigned int externalEnd; // leaf edges [edgeBegin, externalEnd) also border a triangle outside the cluster
+};
+
+// LEVELS OF DETAIL: THE FULL RESOLUTION MESH (LEVEL 0) PLUS LOD_LEVELS - 1 SIMPLIFIED COPIES
+const int LOD_LEVELS = 4;
+
+// BVH SUBTREE THAT IS SIMPLIFIED ON ITS OWN WITH ITS BORDER LOCKED, SO NEIGHBOURING CHUNKS DRAWN AT
+// DIFFERENT LEVELS STILL MEET WITHOUT CRACKS. LEVEL 0 IS THE NODE ITSELF, ENTRY 0 OF THE RANGES IS UNUSED.
+struct LODChunk
+{
+    unsigned int node;
+    unsigned int firstVertex[LOD_LEVELS];   // vertex and triangle ranges in Mesh::lods[level - 1]
+    unsigned int vertexCount[LOD_LEVELS];
+    unsigned int firstTriangle[LOD_LEVELS];
+    unsigned int triangleCount[LOD_LEVELS];
+    float error[LOD_LEVELS];                // object space error bound of each level (0 at level 0)
+};
+
+// ONE SIMPLIFIED LEVEL, STORED CHUNK BY CHUNK WITH ITS OWN COPY OF THE VERTICES IT KEEPS
+struct MeshLOD
+{
+    MeshBuffer<float> vertices;
+    MeshBuffer<unsigned int> indices;
+    std::vector<MeshEdge> edges;          // chunk by chunk, edges on a chunk border have no face1
+    std::vector<unsigned int> chunkEdges; // chunk c owns edges [chunkEdges[c], chunkEdges[c + 1])
+    VertexStreams vertexStreams;
+    FacePlanes facePlanes;
+    int VertexCount() const { return static_cast<int>(vertices.size() / 3); }
+    int TriangleCount() const { return static_cast<int>(indices.size() / 3); }
+};
 
 struct Mesh
 {
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    MeshBuffer<float> vertices;
+    MeshBuffer<unsigned int> indices;
+    MeshBuffer<unsigned char> edgeMasks; // per triangle, bit n set if edge (corner n, corner n+1) is a polygon edge
+    std::vector<MeshEdge> edges;
+    std::vector<unsigned char> edgeFeatures; // optional, per edge 1 if it is a crease or boundary
+    VertexStreams vertexStreams; // optional SoA copy of the vertices for SIMD transforms
+    FacePlanes facePlanes;       // optional per triangle planes for backface culling
+    std::vector<BVHNode> bvh;    // optional, root first
+    std::vector<Meshlet> meshlets; // optional, one per BVH leaf
+    std::vector<LODChunk> lodChunks;         // optional, in BVH order
+    std::vector<MeshLOD> lods;               // levels 1 .. LOD_LEVELS - 1
+    std::vector<unsigned int> lodBorderEdges;  // BVH leaf n: edges owned by another chunk whose face1 lies in n,
+    std::vector<unsigned int> lodBorderStarts; // [lodBorderStarts[n], lodBorderStarts[n + 1])
+    std::vector<unsigned int> lodBorderVertices; // 2 per border edge: its ends as face1's vertices (welded edges keep face0's)
     glm::vec3 position;
     glm::vec3 rotation;
     glm::vec3 scale;
-    int VertexCount() { return static_cast<int>(vertices.size() / 3); }
-};
\ No newline at end of file
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    int VertexCount() const { return static_cast<int>(vertices.size() / 3); }
+    int TriangleCount() const { return static_cast<int>(indices.size() / 3); }
+};
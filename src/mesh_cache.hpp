@@ -0,0 +1,286 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+#include <type_traits>
+#include "mesh.hpp"
+#include "mapped_file.hpp"
+
+// BINARY MESH CACHE WRITTEN NEXT TO THE SOURCE FILE (<source>.meshcache)
+// LAYOUT: HEADER | VERTEX FLOATS | INDICES | EDGE MASKS | BVH NODES | LOD CHUNKS | PER LOD LEVEL VERTEX
+// FLOATS AND INDICES, EACH ARRAY 16-BYTE ALIGNED. THE BVH AND LOD ARRAYS ARE EMPTY UNTIL THE MESH HAS BEEN
+// PREPARED ONCE (THE BVH REORDERS THE MESH ARRAYS, SO THEY ARE STORED IN THAT ORDER THEN). THE MESH IS
+// STORED AS IMPORTED, AFTER OptimizeVoxelMesh.
+const uint32_t MESH_CACHE_MAGIC = 0x4843574D; // "MWCH"
+const uint32_t MESH_CACHE_VERSION = 4;
+
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t vertexOffset;
+    uint64_t vertexFloatCount;
+    uint64_t indexOffset;
+    uint64_t indexCount;
+    uint64_t edgeMaskOffset;
+    uint64_t edgeMaskCount;
+    uint64_t bvhOffset;
+    uint64_t bvhCount;
+    uint64_t lodChunkOffset;
+    uint64_t lodChunkCount;
+    uint64_t lodVertexOffset[LOD_LEVELS - 1];
+    uint64_t lodVertexFloatCount[LOD_LEVELS - 1];
+    uint64_t lodIndexOffset[LOD_LEVELS - 1];
+    uint64_t lodIndexCount[LOD_LEVELS - 1];
+    float boundsMin[3];
+    float boundsMax[3];
+};
+static_assert(std::is_trivially_copyable<MeshCacheHeader>::value, "cache header must be trivially copyable");
+static_assert(std::is_trivially_copyable<BVHNode>::value, "BVH nodes are cached as raw bytes");
+static_assert(std::is_trivially_copyable<LODChunk>::value, "LOD chunks are cached as raw bytes");
+
+std::string MeshCachePath(const std::string &filepath)
+{
+    return filepath + ".meshcache";
+}
+
+uint64_t AlignCacheOffset(uint64_t offset)
+{
+    return (offset + 15) & ~uint64_t(15);
+}
+
+// SIZE AND MODIFICATION TIME OF THE SOURCE FILE THAT KEY THE CACHE
+bool SourceFileStamp(const std::string &filepath, uint64_t &size, int64_t &time)
+{
+    std::error_code error;
+    size = static_cast<uint64_t>(std::filesystem::file_size(filepath, error));
+    if (error) return false;
+    time = static_cast<int64_t>(std::filesystem::last_write_time(filepath, error).time_since_epoch().count());
+    return !error;
+}
+
+// CHECK WHAT THE RENDERER INDEXES WITHOUT BOUNDS CHECKS: EVERY INDEX NAMES A VERTEX, THE BVH IS A TREE IN
+// DEPTH FIRST ORDER (LEFT CHILD NEXT) WHOSE CHILDREN SPLIT THEIR PARENT'S TRIANGLES, AND EVERY LOD CHUNK'S
+// RANGES AND INDICES LIE INSIDE ITS LEVEL
+bool ValidMeshCacheTables(const Mesh &mesh)
+{
+    uint64_t vertexCount = mesh.vertices.size() / 3;
+    uint64_t triangleCount = mesh.indices.size() / 3;
+    const unsigned int *indices = mesh.indices.data();
+    if (mesh.indices.size() > 0 && *std::max_element(indices, indices + mesh.indices.size()) >= vertexCount) return false;
+
+    const std::vector<BVHNode> &nodes = mesh.bvh;
+    if (nodes.empty()) return mesh.lodChunks.empty();
+    if (nodes[0].firstTriangle != 0 || nodes[0].triangleCount != triangleCount) return false;
+    std::vector<unsigned int> stack = {0};
+    size_t visited = 0;
+    while (!stack.empty())
+    {
+        unsigned int n = stack.back();
+        stack.pop_back();
+        if (n != visited++) return false;
+        const BVHNode &node = nodes[n];
+        if (static_cast<uint64_t>(node.firstTriangle) + node.triangleCount > triangleCount) return false;
+        if (node.vertexBegin > node.vertexEnd || node.vertexEnd > vertexCount) return false;
+        if (node.lodChunk != NO_LOD_CHUNK && (node.lodChunk >= mesh.lodChunks.size() || mesh.lodChunks[node.lodChunk].node != n)) return false;
+        if (node.rightChild == 0) continue;
+        if (n + size_t(1) >= nodes.size() || node.rightChild <= n + 1 || node.rightChild >= nodes.size()) return false;
+        const BVHNode &left = nodes[n + 1];
+        const BVHNode &right = nodes[node.rightChild];
+        if (left.firstTriangle != node.firstTriangle || right.firstTriangle != left.firstTriangle + left.triangleCount ||
+            static_cast<uint64_t>(left.triangleCount) + right.triangleCount != node.triangleCount) return false;
+        stack.push_back(node.rightChild);
+        stack.push_back(n + 1);
+    }
+    if (visited != nodes.size()) return false;
+
+    if (mesh.lodChunks.empty()) return true;
+    if (mesh.lods.size() != LOD_LEVELS - 1) return false;
+    for (size_t c = 0; c < mesh.lodChunks.size(); ++c)
+    {
+        const LODChunk &chunk = mesh.lodChunks[c];
+        if (chunk.node >= nodes.size() || nodes[chunk.node].lodChunk != c) return false;
+        for (int level = 1; level < LOD_LEVELS; ++level)
+        {
+            const MeshLOD &lod = mesh.lods[level - 1];
+            uint64_t vertexEnd = static_cast<uint64_t>(chunk.firstVertex[level]) + chunk.vertexCount[level];
+            if (vertexEnd > lod.vertices.size() / 3) return false;
+            if (static_cast<uint64_t>(chunk.firstTriangle[level]) + chunk.triangleCount[level] > lod.indices.size() / 3) return false;
+            const unsigned int *chunkIndices = lod.indices.data() + chunk.firstTriangle[level] * size_t(3);
+            for (size_t i = 0; i < chunk.triangleCount[level] * size_t(3); ++i)
+            {
+                if (chunkIndices[i] < chunk.firstVertex[level] || chunkIndices[i] >= vertexEnd) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// MAP A VALID CACHE AND POINT THE MESH STRAIGHT INTO IT (NOTHING IS COPIED OR PARSED)
+bool LoadMeshCache(const std::string &filepath, Mesh &mesh)
+{
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!SourceFileStamp(filepath, sourceSize, sourceTime)) return false;
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(MeshCachePath(filepath));
+    if (!file->IsOpen() || file->Size() < sizeof(MeshCacheHeader)) return false;
+
+
+
+    // REJECT FOREIGN, OUTDATED OR STALE CACHES
+    MeshCacheHeader header;
+    std::memcpy(&header, file->Data(), sizeof(header));
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION) return false;
+    if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) return false;
+
+    // EVERY ARRAY MUST BE ALIGNED AND INSIDE THE FILE (WRITTEN SO THAT IT CANNOT OVERFLOW)
+    uint64_t size = file->Size();
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize)
+    {
+        return offset % 16 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    bool valid = fits(header.vertexOffset, header.vertexFloatCount, sizeof(float)) &&
+                 fits(header.indexOffset, header.indexCount, sizeof(unsigned int)) &&
+                 fits(header.edgeMaskOffset, header.edgeMaskCount, 1) &&
+                 fits(header.bvhOffset, header.bvhCount, sizeof(BVHNode)) &&
+                 fits(header.lodChunkOffset, header.lodChunkCount, sizeof(LODChunk));
+    for (int l = 0; l < LOD_LEVELS - 1; ++l)
+    {
+        valid = valid && fits(header.lodVertexOffset[l], header.lodVertexFloatCount[l], sizeof(float)) &&
+                         fits(header.lodIndexOffset[l], header.lodIndexCount[l], sizeof(unsigned int));
+    }
+    if (!valid)
+    {
+        std::cerr << "[MeshCache] Warning: Ignoring truncated cache '" << MeshCachePath(filepath) << "'" << std::endl;
+        return false;
+    }
+
+
+
+    // VIEW THE ARRAYS IN PLACE, THE MESH BUFFERS KEEP THE MAPPING ALIVE
+    const float *vertices = reinterpret_cast<const float*>(file->Data() + header.vertexOffset);
+    const unsigned int *indices = reinterpret_cast<const unsigned int*>(file->Data() + header.indexOffset);
+    mesh.vertices = MeshBuffer<float>::View(file, vertices, header.vertexFloatCount);
+    mesh.indices = MeshBuffer<unsigned int>::View(file, indices, header.indexCount);
+    mesh.edgeMasks = MeshBuffer<unsigned char>::View(file, reinterpret_cast<const unsigned char*>(file->Data() + header.edgeMaskOffset), header.edgeMaskCount);
+    mesh.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    mesh.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+    // THE BVH AND LOD TABLES ARE SMALL AND COPIED, THE LOD LEVELS ARE VIEWED LIKE THE MESH ARRAYS
+    mesh.bvh.resize(header.bvhCount);
+    mesh.lodChunks.resize(header.lodChunkCount);
+    std::memcpy(mesh.bvh.data(), file->Data() + header.bvhOffset, header.bvhCount * sizeof(BVHNode));
+    std::memcpy(mesh.lodChunks.data(), file->Data() + header.lodChunkOffset, header.lodChunkCount * sizeof(LODChunk));
+    mesh.lods.clear();
+    if (header.lodChunkCount > 0)
+    {
+        mesh.lods.resize(LOD_LEVELS - 1);
+        for (int l = 0; l < LOD_LEVELS - 1; ++l)
+        {
+            mesh.lods[l].vertices = MeshBuffer<float>::View(file, reinterpret_cast<const float*>(file->Data() + header.lodVertexOffset[l]), header.lodVertexFloatCount[l]);
+            mesh.lods[l].indices = MeshBuffer<unsigned int>::View(file, reinterpret_cast<const unsigned int*>(file->Data() + header.lodIndexOffset[l]), header.lodIndexCount[l]);
+        }
+    }
+
+    // THE TABLES ARE USED WITHOUT FURTHER CHECKS, SO A CORRUPT CACHE IS REBUILT FROM THE SOURCE
+    if (!ValidMeshCacheTables(mesh))
+    {
+        std::cerr << "[MeshCache] Warning: Ignoring corrupt cache '" << MeshCachePath(filepath) << "'" << std::endl;
+        mesh = Mesh();
+        return false;
+    }
+    return true;
+}
+
+// WRITE THE CACHE TO A TEMPORARY FILE AND MOVE IT INTO PLACE ONCE COMPLETE
+bool SaveMeshCache(const std::string &filepath, const Mesh &mesh)
+{
+    MeshCacheHeader header = {};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    if (!SourceFileStamp(filepath, header.sourceSize, header.sourceTime)) return false;
+
+    // ARRAYS IN FILE ORDER, EACH PLACED AT THE NEXT ALIGNED OFFSET
+    struct CacheArray
+    {
+        const void *data;
+        uint64_t bytes;
+    };
+    std::vector<CacheArray> arrays;
+    uint64_t offset = sizeof(MeshCacheHeader);
+    auto place = [&](const void *data, uint64_t count, uint64_t elementSize, uint64_t &arrayOffset, uint64_t &arrayCount)
+    {
+        arrayOffset = AlignCacheOffset(offset);
+        arrayCount = count;
+        offset = arrayOffset + count * elementSize;
+        arrays.push_back({data, count * elementSize});
+    };
+    bool lods = !mesh.lodChunks.empty() && mesh.lods.size() == LOD_LEVELS - 1;
+    place(mesh.vertices.data(), mesh.vertices.size(), sizeof(float), header.vertexOffset, header.vertexFloatCount);
+    place(mesh.indices.data(), mesh.indices.size(), sizeof(unsigned int), header.indexOffset, header.indexCount);
+    place(mesh.edgeMasks.data(), mesh.edgeMasks.size(), 1, header.edgeMaskOffset, header.edgeMaskCount);
+    place(mesh.bvh.data(), mesh.bvh.size(), sizeof(BVHNode), header.bvhOffset, header.bvhCount);
+    place(mesh.lodChunks.data(), lods ? mesh.lodChunks.size() : 0, sizeof(LODChunk), header.lodChunkOffset, header.lodChunkCount);
+    for (int l = 0; l < LOD_LEVELS - 1; ++l)
+    {
+        const MeshLOD *lod = lods ? &mesh.lods[l] : nullptr;
+        place(lod ? lod->vertices.data() : nullptr, lod ? lod->vertices.size() : 0, sizeof(float), header.lodVertexOffset[l], header.lodVertexFloatCount[l]);
+        place(lod ? lod->indices.data() : nullptr, lod ? lod->indices.size() : 0, sizeof(unsigned int), header.lodIndexOffset[l], header.lodIndexCount[l]);
+    }
+    for (int i=0; i<3; ++i)
+    {
+        header.boundsMin[i] = mesh.boundsMin[i];
+        header.boundsMax[i] = mesh.boundsMax[i];
+    }
+
+
+
+    // WRITE HEADER AND ARRAYS WITH ZERO PADDING BETWEEN THEM
+    std::string cachePath = MeshCachePath(filepath);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "[MeshCache] Warning: Could not write '" << tempPath << "'" << std::endl;
+            return false;
+        }
+
+        const char padding[16] = {};
+        uint64_t written = sizeof(header);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const CacheArray &array : arrays)
+        {
+            uint64_t aligned = AlignCacheOffset(written);
+            file.write(padding, aligned - written);
+            if (array.bytes > 0) file.write(reinterpret_cast<const char*>(array.data), array.bytes);
+            written = aligned + array.bytes;
+        }
+        if (!file.good())
+        {
+            std::cerr << "[MeshCache] Warning: Failed while writing '" << tempPath << "'" << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error)
+    {
+        std::cerr << "[MeshCache] Warning: Could not replace '" << cachePath << "': " << error.message() << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "mesh.hpp"
+#include "edges.hpp"
+#include "bvh.hpp"
+#include "meshlets.hpp"
+#include "lod.hpp"
+#include "vertex_streams.hpp"
+#include "face_planes.hpp"
+#include "mesh_cache.hpp"
+
+// BUILD DERIVED MESH DATA ONCE THE MESH IS FULLY LOADED (THE BVH REORDERS THE MESH, SO IT GOES FIRST).
+// THE BVH AND LOD LEVELS COME FROM THE CACHE WHEN IT HAS THEM, OTHERWISE THEY ARE BUILT AND CACHED.
+void PrepareMesh(Mesh &mesh, const std::string &filepath)
+{
+    bool rebuilt = false;
+    if (mesh.bvh.empty() || mesh.bvh[0].triangleCount != static_cast<unsigned int>(mesh.TriangleCount()))
+    {
+        BuildBVH(mesh);
+        rebuilt = true;
+    }
+    BuildEdges(mesh);
+    LinkBVHEdges(mesh);
+    BuildMeshlets(mesh);
+    if (mesh.lodChunks.empty())
+    {
+        BuildLODs(mesh);
+        rebuilt = true;
+    }
+    PrepareLODs(mesh);
+    BuildVertexStreams(mesh.vertices.data(), mesh.VertexCount(), mesh.vertexStreams);
+    BuildFacePlanes(mesh.vertices.data(), mesh.indices.data(), mesh.TriangleCount(), mesh.facePlanes);
+    BuildEdgeFeatures(mesh.edges, mesh.facePlanes, EDGE_CREASE_DEGREES, mesh.edgeFeatures);
+    if (rebuilt) SaveMeshCache(filepath, mesh);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include "mesh.hpp"
+
+// CLUSTERS WHOSE NORMALS SPREAD THIS CLOSE TO A HEMISPHERE ARE NEVER REJECTED (THE CONE WOULD NOT HELP)
+const float MESHLET_MIN_CONE_DOT = 0.1f;
+
+// TURN EVERY BVH LEAF INTO A MESHLET: BOUNDING SPHERE, NORMAL CONE, AND ITS EDGES REORDERED SO THE ONES
+// SHARED WITH TRIANGLES OUTSIDE THE LEAF COME FIRST. RUN AFTER LinkBVHEdges.
+void BuildMeshlets(Mesh &mesh)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    mesh.meshlets.clear();
+    if (mesh.bvh.empty()) return;
+
+    std::vector<unsigned int> leaves;
+    for (size_t n = 0; n < mesh.bvh.size(); ++n)
+    {
+        if (mesh.bvh[n].rightChild != 0) continue;
+        mesh.bvh[n].meshlet = static_cast<unsigned int>(leaves.size());
+        leaves.push_back(static_cast<unsigned int>(n));
+    }
+    mesh.meshlets.resize(leaves.size());
+
+    const float *vertices = mesh.vertices.data();
+    const unsigned int *indices = mesh.indices.data();
+    #pragma omp parallel for schedule(dynamic)
+    for (long long m = 0; m < static_cast<long long>(leaves.size()); ++m)
+    {
+        const BVHNode &node = mesh.bvh[leaves[m]];
+        Meshlet &meshlet = mesh.meshlets[m];
+        unsigned int firstTriangle = node.firstTriangle;
+        unsigned int endTriangle = node.firstTriangle + node.triangleCount;
+
+        // SPHERE AROUND THE LEAF BOX CENTER
+        meshlet.center = (node.boundsMin + node.boundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (size_t i = firstTriangle * size_t(3); i < endTriangle * size_t(3); ++i)
+        {
+            const float *v = vertices + indices[i] * size_t(3);
+            glm::vec3 offset = glm::vec3(v[0], v[1], v[2]) - meshlet.center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        meshlet.radius = std::sqrt(radiusSquared);
+
+        // CONE AXIS IS THE MEAN UNIT NORMAL, THE HALF ANGLE COVERS THE NORMAL FURTHEST FROM IT.
+        // DEGENERATE TRIANGLES HAVE NO NORMAL AND ARE NEVER FRONT FACING, SO THEY ARE SKIPPED.
+        std::vector<glm::vec3> normals;
+        normals.reserve(node.triangleCount);
+        glm::vec3 axis = glm::vec3(0.0f);
+        for (unsigned int face = firstTriangle; face < endTriangle; ++face)
+        {
+            const unsigned int *corners = indices + face * size_t(3);
+            glm::vec3 v1 = glm::vec3(vertices[corners[0] * 3], vertices[corners[0] * 3 + 1], vertices[corners[0] * 3 + 2]);
+            glm::vec3 v2 = glm::vec3(vertices[corners[1] * 3], vertices[corners[1] * 3 + 1], vertices[corners[1] * 3 + 2]);
+            glm::vec3 v3 = glm::vec3(vertices[corners[2] * 3], vertices[corners[2] * 3 + 1], vertices[corners[2] * 3 + 2]);
+            glm::vec3 normal = glm::cross(v2 - v1, v3 - v1);
+            float length = glm::length(normal);
+            if (!(length > 0.0f)) continue;
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+        float axisLength = glm::length(axis);
+        meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+        for (const glm::vec3 &normal : normals) minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+        meshlet.coneCutoff = minDot > MESHLET_MIN_CONE_DOT ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+
+        // EDGES BORDERING ANOTHER CLUSTER FIRST (THE ONLY ONES THAT CAN BE VISIBLE WHEN THIS CLUSTER FACES AWAY)
+        auto external = std::stable_partition(mesh.edges.begin() + node.edgeBegin, mesh.edges.begin() + node.edgeEnd, [&](const MeshEdge &edge)
+        {
+            return edge.face1 != NO_FACE && (edge.face1 < firstTriangle || edge.face1 >= endTriangle);
+        });
+        meshlet.externalEnd = static_cast<unsigned int>(external - mesh.edges.begin());
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "[BuildMeshlets] " << mesh.meshlets.size() << " meshlets in " << milliseconds << " ms" << std::endl;
+}
+
+// TRUE WHEN EVERY TRIANGLE OF THE MESHLET FACES AWAY FROM THE CAMERA. CONSERVATIVE FOR ANY POINT OF THE
+// SPHERE: THE DIRECTION TO IT STAYS WITHIN 90 DEGREES MINUS THE CONE HALF ANGLE OF THE AXIS.
+bool MeshletBackFacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition)
+{
+    glm::vec3 offset = meshlet.center - cameraPosition;
+    return glm::dot(offset, meshlet.coneAxis) >= meshlet.coneCutoff * (glm::length(offset) + meshlet.radius) + meshlet.radius;
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <omp.h>
+#include "mesh.hpp"
+#include "loader.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_prepare.hpp"
+#include "mapped_file.hpp"
+
+// UPPER BOUND ON THE VERTEX FLOATS AND TRIANGLE INDICES AN OBJ RANGE WILL PRODUCE
+void CountOBJ(const char *cursor, const char *end, size_t &vertexFloats, size_t &indices)
+{
+    while (cursor < end)
+    {
+        const char *lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (lineEnd == nullptr) lineEnd = end;
+        cursor = SkipBlanks(cursor, lineEnd);
+
+        if (lineEnd - cursor > 1 && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            // VERTEX LINE
+            if (cursor[0] == 'v') vertexFloats += 3;
+
+            // FACE LINE (ONE TRIANGLE PER CORNER AFTER THE SECOND)
+            if (cursor[0] == 'f')
+            {
+                size_t corners = 0;
+                cursor += 1;
+                while (true)
+                {
+                    cursor = SkipBlanks(cursor, lineEnd);
+                    if (cursor == lineEnd || *cursor == '\r') break;
+                    cursor = SkipToken(cursor, lineEnd);
+                    ++corners;
+                }
+                if (corners > 2) indices += (corners - 2) * 3;
+            }
+        }
+
+        cursor = lineEnd + 1;
+    }
+}
+
+// LOADS AN OBJ ON A BACKGROUND THREAD, PUBLISHING VERTICES AND TRIANGLES IN BATCHES.
+// THE RENDER THREAD POLLS ONCE PER FRAME AND NEVER WAITS: BATCHES ARE WRITTEN INTO
+// STORAGE SIZED UP FRONT AND HANDED OVER BY RELEASE/ACQUIRE ATOMIC COUNTS. THE COMPLETE
+// MESH IS PREPARED (BVH, EDGES, LODS, ...) AND CACHED ON THE WORKER TOO, SO THE RENDER
+// THREAD ONLY SWAPS IT IN.
+class OBJStream
+{
+public:
+    OBJStream() {}
+
+    ~OBJStream()
+    {
+        Stop();
+    }
+
+    OBJStream(const OBJStream&) = delete;
+    OBJStream& operator=(const OBJStream&) = delete;
+
+    void Start(const std::string &filepath)
+    {
+        Stop();
+        cancelled.store(false);
+        finished.store(false);
+        publishedVertexFloats.store(0);
+        publishedIndices.store(0);
+        delivered = false;
+        active = true;
+        worker = std::thread(&OBJStream::Load, this, filepath);
+    }
+
+    void Stop()
+    {
+        cancelled.store(true);
+        if (worker.joinable()) worker.join();
+    }
+
+    bool Finished() const
+    {
+        return finished.load(std::memory_order_acquire);
+    }
+
+    // TRUE ONCE POLL HAS HANDED OVER THE COMPLETE MESH
+    bool Delivered() const
+    {
+        return delivered;
+    }
+
+    // POINT THE MESH AT EVERYTHING PUBLISHED SO FAR, RETURNS TRUE IF IT CHANGED
+    bool Poll(Mesh &mesh)
+    {
+        if (!active || delivered) return false;
+
+        // LOADING COMPLETE, HAND OVER THE FINAL PREPARED MESH
+        if (finished.load(std::memory_order_acquire))
+        {
+            mesh = std::move(completeMesh);
+            delivered = true;
+            return true;
+        }
+
+        // PARTIAL MESH. THE WORKER PUBLISHES VERTICES BEFORE THE INDICES THAT USE THEM, SO THE INDEX COUNT IS
+        // READ FIRST: THE VERTEX COUNT READ AFTER IT IS AT LEAST AS NEW AND COVERS EVERY INDEX
+        size_t indexCount = publishedIndices.load(std::memory_order_acquire);
+        size_t vertexFloats = publishedVertexFloats.load(std::memory_order_acquire);
+        if (vertexFloats == mesh.vertices.size() && indexCount == mesh.indices.size()) return false;
+
+        mesh.vertices = MeshBuffer<float>::View(vertexStorage, vertexStorage.get(), vertexFloats);
+        mesh.indices = MeshBuffer<unsigned int>::View(indexStorage, indexStorage.get(), indexCount);
+        mesh.edgeMasks = MeshBuffer<unsigned char>::View(edgeMaskStorage, edgeMaskStorage.get(), indexCount / 3);
+        return true;
+    }
+
+private:
+    std::thread worker;
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    std::atomic<size_t> publishedVertexFloats{0};
+    std::atomic<size_t> publishedIndices{0};
+    std::shared_ptr<float[]> vertexStorage;
+    std::shared_ptr<unsigned int[]> indexStorage;
+    std::shared_ptr<unsigned char[]> edgeMaskStorage;
+    Mesh completeMesh;
+    bool active = false;
+    bool delivered = false;
+
+    void Finish(Mesh &mesh)
+    {
+        completeMesh = std::move(mesh);
+        finished.store(true, std::memory_order_release);
+    }
+
+    void Load(std::string filepath)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        Mesh mesh;
+
+
+
+        // A VALID CACHE IS PUBLISHED IN ONE GO
+        if (LoadMeshCache(filepath, mesh))
+        {
+            std::cout << "[OBJStream] Mapped cache '" << MeshCachePath(filepath) << "'" << std::endl;
+            PrepareMesh(mesh, filepath);
+            Finish(mesh);
+            return;
+        }
+
+        MappedFile file(filepath);
+        if (!file.IsOpen())
+        {
+            std::cerr << "[OBJStream] Error: Could not open file '" << filepath << "'" << std::endl;
+            Finish(mesh);
+            return;
+        }
+
+
+
+        // SIZE THE STORAGE WITH A PARALLEL COUNTING PASS SO IT NEVER MOVES WHILE BEING READ
+        size_t chunkCount = static_cast<size_t>(omp_get_max_threads()) * 4;
+        std::vector<const char*> boundaries = SplitOBJLines(file.Data(), file.End(), chunkCount);
+        size_t vertexCapacity = 0;
+        size_t indexCapacity = 0;
+        #pragma omp parallel for reduction(+: vertexCapacity, indexCapacity)
+        for (int i = 0; i < static_cast<int>(chunkCount); ++i)
+        {
+            CountOBJ(boundaries[i], boundaries[i + 1], vertexCapacity, indexCapacity);
+        }
+        vertexStorage = std::shared_ptr<float[]>(new float[vertexCapacity]);
+        indexStorage = std::shared_ptr<unsigned int[]>(new unsigned int[indexCapacity]);
+        edgeMaskStorage = std::shared_ptr<unsigned char[]>(new unsigned char[indexCapacity / 3]);
+
+
+
+        // PARSE BATCHES OF LINES AND PUBLISH EACH ONE
+        const size_t batchSize = 1 << 20;
+        OBJChunk batch;
+        size_t vertexFloats = 0;
+        size_t indexCount = 0;
+        bool forwardReferences = false;
+        const char *cursor = file.Data();
+        while (cursor < file.End() && !cancelled.load(std::memory_order_relaxed))
+        {
+            // BATCH ENDS AFTER THE NEXT LINE BREAK
+            const char *batchEnd = cursor + std::min(batchSize, static_cast<size_t>(file.End() - cursor));
+            while (batchEnd < file.End() && batchEnd[-1] != '\n') ++batchEnd;
+
+            batch.vertices.clear();
+            batch.indices.clear();
+            batch.edgeMasks.clear();
+            batch.relativeIndices.clear();
+            ParseOBJ(cursor, batchEnd, batch);
+            cursor = batchEnd;
+
+            // COPY INTO THE SHARED STORAGE, RESOLVING RELATIVE INDICES AGAINST EARLIER BATCHES
+            unsigned int vertexBase = static_cast<unsigned int>(vertexFloats / 3);
+            for (size_t slot : batch.relativeIndices) batch.indices[slot] += vertexBase;
+            std::copy(batch.vertices.begin(), batch.vertices.end(), vertexStorage.get() + vertexFloats);
+            std::copy(batch.indices.begin(), batch.indices.end(), indexStorage.get() + indexCount);
+            std::copy(batch.edgeMasks.begin(), batch.edgeMasks.end(), edgeMaskStorage.get() + indexCount / 3);
+            vertexFloats += batch.vertices.size();
+            indexCount += batch.indices.size();
+
+            // FACES THAT REFERENCE VERTICES NOT YET LOADED HOLD BACK FURTHER TRIANGLES UNTIL THE END
+            for (unsigned int index : batch.indices)
+            {
+                if (index >= vertexFloats / 3) forwardReferences = true;
+            }
+
+            publishedVertexFloats.store(vertexFloats, std::memory_order_release);
+            if (!forwardReferences) publishedIndices.store(indexCount, std::memory_order_release);
+        }
+        if (cancelled.load()) return;
+
+
+
+        // FINAL MESH VIEWS THE STREAMED STORAGE
+        mesh.vertices = MeshBuffer<float>::View(vertexStorage, vertexStorage.get(), vertexFloats);
+        mesh.indices = MeshBuffer<unsigned int>::View(indexStorage, indexStorage.get(), indexCount);
+        mesh.edgeMasks = MeshBuffer<unsigned char>::View(edgeMaskStorage, edgeMaskStorage.get(), indexCount / 3);
+        ComputeBounds(mesh);
+        if (OptimizeVoxelMesh(mesh)) ComputeBounds(mesh);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+        std::cout << "[OBJStream] Streamed '" << filepath << "' in " << seconds * 1000.0 << " ms" << std::endl;
+
+        // BUILD EVERYTHING THE RENDERER NEEDS AND WRITE THE CACHE ONCE, STILL OFF THE RENDER THREAD
+        PrepareMesh(mesh, filepath);
+        if (cancelled.load()) return;
+        Finish(mesh);
+    }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "aligned_allocator.hpp"
+
+typedef std::vector<float, AlignedAllocator<float, 64>> AlignedFloats;
+
+// STRUCTURE-OF-ARRAYS COPY OF THE MESH VERTICES FOR SIMD TRANSFORMS.
+// EACH ARRAY IS 64-BYTE ALIGNED AND ZERO PADDED TO A MULTIPLE OF 16 ELEMENTS.
+const size_t VERTEX_STREAM_PADDING = 16;
+
+struct VertexStreams
+{
+    AlignedFloats x;
+    AlignedFloats y;
+    AlignedFloats z;
+    size_t count = 0; // real vertex count (arrays hold PaddedCount() elements)
+
+    size_t PaddedCount() const { return x.size(); }
+    bool empty() const { return count == 0; }
+};
+
+// SPLIT INTERLEAVED XYZ FLOATS INTO SEPARATE PADDED STREAMS
+void BuildVertexStreams(const float *vertices, size_t vertexCount, VertexStreams &streams)
+{
+    size_t padded = (vertexCount + VERTEX_STREAM_PADDING - 1) / VERTEX_STREAM_PADDING * VERTEX_STREAM_PADDING;
+    streams.x.assign(padded, 0.0f);
+    streams.y.assign(padded, 0.0f);
+    streams.z.assign(padded, 0.0f);
+    streams.count = vertexCount;
+
+    #pragma omp parallel for
+    for (long long i = 0; i < static_cast<long long>(vertexCount); ++i)
+    {
+        streams.x[i] = vertices[i * 3];
+        streams.y[i] = vertices[i * 3 + 1];
+        streams.z[i] = vertices[i * 3 + 2];
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include "../libs/glm/glm.hpp"
+#include "camera.h"
+#include "mesh.hpp"
+#include "framebuffer.hpp"
+#include "RenderSystem.hpp"
+#include "batch_render.hpp"
+#include "frame_writer.hpp"
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <fcntl.h>
+#endif
+
+// RAW VIDEO FORMATS FOR PIPING FRAMES INTO AN ENCODER
+const int VIDEO_FORMAT_Y4M = 0;   // YUV4MPEG2, 4:4:4 (ONE PIXEL WIDE LINES SURVIVE), BT.601 LIMITED RANGE
+const int VIDEO_FORMAT_RGB24 = 1; // HEADERLESS PACKED RGB, THE ENCODER IS TOLD THE SIZE AND RATE
+
+// WRITES FRAMES STRAIGHT FROM A FRAMEBUFFER TO STDOUT ("-") OR A FILE / NAMED PIPE, ONE ROW AT A TIME
+struct VideoStream
+{
+    FILE *file = nullptr;
+    int format = VIDEO_FORMAT_Y4M;
+    std::vector<uint8_t> row;
+
+    bool Open(const std::string &filepath, int videoFormat, int width, int height, int framesPerSecond)
+    {
+        format = videoFormat;
+#ifndef _WIN32
+        // AN ENCODER THAT EXITS EARLY (-t, head -c) MUST FAIL THE WRITE, NOT KILL THE PROCESS WITH SIGPIPE
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        if (filepath == "-")
+        {
+            file = stdout;
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        }
+        else file = std::fopen(filepath.c_str(), "wb");
+        if (!file)
+        {
+            std::cerr << "[VideoStream] Error: Could not open '" << filepath << "'" << std::endl;
+            return false;
+        }
+        row.resize(static_cast<size_t>(width) * 3);
+        if (format == VIDEO_FORMAT_Y4M) std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, framesPerSecond);
+        return !std::ferror(file);
+    }
+
+    bool WriteFrame(const Framebuffer &framebuffer)
+    {
+        int width = framebuffer.width;
+        if (format == VIDEO_FORMAT_RGB24)
+        {
+            for (int y = 0; y < framebuffer.height; ++y)
+            {
+                FramebufferRowRGB(framebuffer, y, row.data());
+                std::fwrite(row.data(), 1, static_cast<size_t>(width) * 3, file);
+            }
+            return !std::ferror(file);
+        }
+
+        // Y, THEN U, THEN V PLANE
+        std::fputs("FRAME\n", file);
+        for (int plane = 0; plane < 3; ++plane)
+        {
+            for (int y = 0; y < framebuffer.height; ++y)
+            {
+                const uint8_t *rgba = framebuffer.Bytes() + static_cast<size_t>(y) * width * 4;
+                for (int x = 0; x < width; ++x)
+                {
+                    int r = rgba[x * 4], g = rgba[x * 4 + 1], b = rgba[x * 4 + 2];
+                    int value;
+                    if (plane == 0) value = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+                    else if (plane == 1) value = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+                    else value = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+                    row[x] = static_cast<uint8_t>(value);
+                }
+                std::fwrite(row.data(), 1, width, file);
+            }
+        }
+        return !std::ferror(file);
+    }
+
+    bool Close()
+    {
+        if (!file) return true;
+        bool ok = std::fflush(file) == 0 && !std::ferror(file);
+        if (file != stdout) ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+};
+
+// RENDER FRAMECOUNT FRAMES ALONG THE PATH IN ORDER AND STREAM THEM. A FRAME WRITER CONVERTS AND WRITES
+// ONE FRAME WHILE THE NEXT IS RASTERIZED, SO A SLOW PIPE ONLY STALLS RENDERING ONCE BOTH BUFFERS ARE WAITING.
+bool StreamCameraPath(const Mesh &mesh, const std::vector<CameraKey> &keys, int frameCount, int width, int height, int edgeMode,
+                      const std::string &filepath, int format, int framesPerSecond)
+{
+    VideoStream stream;
+    if (!stream.Open(filepath, format, width, height, framesPerSecond)) return false;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Camera camera;
+    RenderContext context;
+    camera.SetViewport(width, height);
+    context.edgeMode = edgeMode;
+    FrameWriter writer(width, height, [&](int, const Framebuffer &framebuffer) { return stream.WriteFrame(framebuffer); });
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        Framebuffer *framebuffer = writer.Next();
+        if (!framebuffer) break;
+        CameraKey key = CameraKeyAt(keys, frameCount > 1 ? static_cast<float>(frame) / static_cast<float>(frameCount - 1) : 0.0f);
+        camera.position = key.position;
+        camera.rotation = key.rotation;
+        camera.UpdateProjectionView();
+        framebuffer->Clear(PIXEL_BLACK);
+        DrawWireframe(mesh, camera, *framebuffer, context);
+        writer.Submit(frame);
+    }
+    bool written = writer.Finish();
+    bool closed = stream.Close();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    if (!written || !closed) std::cerr << "[VideoStream] Error: Writing '" << filepath << "' failed" << std::endl;
+    else std::cerr << "[VideoStream] " << frameCount << " frames of " << width << "x" << height << " in " << seconds << " s (" << frameCount / seconds << " frames/s)" << std::endl;
+    return written && closed;
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include "mesh.hpp"
+
+// AXIS ALIGNED FACES ARE MATCHED ON A GRID OF 2^-VOXEL_GRID_BITS TIMES THE MESH EXTENT, WHICH ABSORBS THE
+// FLOAT NOISE OF EXPORTERS (17.000004 VS 16.999998) BUT NOT REAL DETAIL
+const int VOXEL_GRID_BITS = 20;
+
+// PLANES WHOSE CELL GRID WOULD BE LARGER THAN THIS KEEP THEIR TRIANGLES
+const size_t VOXEL_MAX_CELLS = size_t(1) << 24;
+
+// AXIS ALIGNED TRIANGLES OF ONE PLANE. U AND V ARE THE OTHER TWO AXES IN CYCLIC ORDER, SO A TRIANGLE WITH
+// POSITIVE AREA IN (U, V) FACES ALONG +AXIS. THE CELLS LIE BETWEEN THE DISTINCT U AND V COORDINATES.
+struct VoxelPlane
+{
+    int axis;
+    int64_t coordinate;
+    std::vector<unsigned int> triangles;
+    std::vector<int64_t> corners;        // 9 grid coordinates (x, y, z per corner) per triangle
+    std::vector<int64_t> us;
+    std::vector<int64_t> vs;
+    std::vector<unsigned char> coverage; // per cell, bit 0: a face looks along +axis, bit 1: along -axis
+    std::vector<size_t> hiddenCells;     // cells between two solids
+    std::vector<int64_t> rectangles;     // u0, v0, u1, v1, sign (+1 / -1), outline begin, end per merged rectangle
+    std::vector<int64_t> outline;        // counterclockwise u, v, open per rectangle boundary point
+    bool remeshed = false;
+};
+
+// DOUBLED SIGNED AREA OF (A, B, C) IN GRID UNITS
+int64_t VoxelCross(int64_t au, int64_t av, int64_t bu, int64_t bv, int64_t cu, int64_t cv)
+{
+    return (bu - au) * (cv - av) - (bv - av) * (cu - au);
+}
+
+// RASTERIZE A PLANE'S TRIANGLES ONTO ITS CELLS. THE PLANE CAN ONLY BE REMESHED WHEN ITS TRIANGLES ARE AXIS
+// ALIGNED RIGHT TRIANGLES THAT TILE THE COVERED CELLS EXACTLY, SO THE SURFACE NEVER CHANGES.
+void RasterizeVoxelPlane(VoxelPlane &plane)
+{
+    int u = (plane.axis + 1) % 3;
+    int v = (plane.axis + 2) % 3;
+    std::vector<int64_t> &us = plane.us;
+    std::vector<int64_t> &vs = plane.vs;
+    for (size_t t = 0; t < plane.triangles.size(); ++t)
+    {
+        const int64_t *corners = &plane.corners[t * 9];
+        for (int k = 0; k < 3; ++k)
+        {
+            us.push_back(corners[k * 3 + u]);
+            vs.push_back(corners[k * 3 + v]);
+        }
+    }
+    std::sort(us.begin(), us.end());
+    us.erase(std::unique(us.begin(), us.end()), us.end());
+    std::sort(vs.begin(), vs.end());
+    vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+    size_t columns = us.size() - 1;
+    size_t rows = vs.size() - 1;
+    if (columns * rows > VOXEL_MAX_CELLS) return;
+
+
+
+    // COVERAGE PER SIDE (BIT 0: FACING +AXIS, BIT 1: FACING -AXIS) BY CELL CENTER, EDGES INCLUSIVE. A CENTER
+    // ON A QUAD DIAGONAL IS INSIDE BOTH HALVES, THE UNION IS STILL RIGHT.
+    std::vector<unsigned char> &coverage = plane.coverage;
+    coverage.assign(columns * rows, 0);
+    int64_t triangleArea[2] = {0, 0};
+    for (size_t t = 0; t < plane.triangles.size(); ++t)
+    {
+        const int64_t *corners = &plane.corners[t * 9];
+        int64_t pu[3], pv[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            pu[k] = corners[k * 3 + u];
+            pv[k] = corners[k * 3 + v];
+        }
+        int64_t area = VoxelCross(pu[0], pv[0], pu[1], pv[1], pu[2], pv[2]);
+        int side = area > 0 ? 0 : 1;
+        triangleArea[side] += std::abs(area);
+
+        // BOTH LEGS MUST RUN ALONG U AND V
+        bool sameU = pu[0] == pu[1] || pu[1] == pu[2] || pu[2] == pu[0];
+        bool sameV = pv[0] == pv[1] || pv[1] == pv[2] || pv[2] == pv[0];
+        if (!sameU || !sameV) return;
+
+        size_t i0 = std::lower_bound(us.begin(), us.end(), std::min({pu[0], pu[1], pu[2]})) - us.begin();
+        size_t i1 = std::lower_bound(us.begin(), us.end(), std::max({pu[0], pu[1], pu[2]})) - us.begin();
+        size_t j0 = std::lower_bound(vs.begin(), vs.end(), std::min({pv[0], pv[1], pv[2]})) - vs.begin();
+        size_t j1 = std::lower_bound(vs.begin(), vs.end(), std::max({pv[0], pv[1], pv[2]})) - vs.begin();
+        for (size_t j = j0; j < j1; ++j)
+        {
+            for (size_t i = i0; i < i1; ++i)
+            {
+                // DOUBLED COORDINATES KEEP THE CENTER ON THE INTEGER GRID
+                int64_t cu = us[i] + us[i + 1];
+                int64_t cv = vs[j] + vs[j + 1];
+                int64_t e0 = VoxelCross(pu[0] * 2, pv[0] * 2, pu[1] * 2, pv[1] * 2, cu, cv);
+                int64_t e1 = VoxelCross(pu[1] * 2, pv[1] * 2, pu[2] * 2, pv[2] * 2, cu, cv);
+                int64_t e2 = VoxelCross(pu[2] * 2, pv[2] * 2, pu[0] * 2, pv[0] * 2, cu, cv);
+                bool inside = side == 0 ? (e0 >= 0 && e1 >= 0 && e2 >= 0) : (e0 <= 0 && e1 <= 0 && e2 <= 0);
+                if (inside) coverage[j * columns + i] |= static_cast<unsigned char>(1 << side);
+            }
+        }
+    }
+
+    int64_t coveredArea[2] = {0, 0};
+    for (size_t j = 0; j < rows; ++j)
+    {
+        for (size_t i = 0; i < columns; ++i)
+        {
+            int64_t area = (us[i + 1] - us[i]) * (vs[j + 1] - vs[j]) * 2;
+            if (coverage[j * columns + i] & 1) coveredArea[0] += area;
+            if (coverage[j * columns + i] & 2) coveredArea[1] += area;
+        }
+    }
+    plane.remeshed = coveredArea[0] == triangleArea[0] && coveredArea[1] == triangleArea[1];
+}
+
+// FACES OF A PLANE AT A DOUBLED (U, V) POSITION (0 OUTSIDE ITS CELLS)
+unsigned char VoxelCoverageAt(const VoxelPlane &plane, int64_t cu, int64_t cv)
+{
+    if (cu <= plane.us.front() * 2 || cu >= plane.us.back() * 2 || cv <= plane.vs.front() * 2 || cv >= plane.vs.back() * 2) return 0;
+    size_t i = std::upper_bound(plane.us.begin(), plane.us.end(), cu / 2) - plane.us.begin() - 1;
+    size_t j = std::upper_bound(plane.vs.begin(), plane.vs.end(), cv / 2) - plane.vs.begin() - 1;
+    return plane.coverage[j * (plane.us.size() - 1) + i];
+}
+
+// FIND THE CELLS WHERE TWO OPPOSITE FACES MEET BETWEEN TWO SOLIDS. THE FACE LOOKING ALONG +AXIS BELONGS TO
+// A SOLID BELOW THE PLANE, SO THE NEAREST FACE BELOW MUST BE THAT SOLID'S BACK (LOOKING ALONG -AXIS), AND
+// THE SAME ABOVE. A DOUBLE SIDED PANE HAS NO SUCH BACKS AND KEEPS ITS FACES. ORDER LISTS THE PLANES OF THE
+// AXIS BY COORDINATE, POSITION IS THIS PLANE'S PLACE IN IT.
+void FindHiddenVoxelCells(const std::vector<VoxelPlane> &planes, const std::vector<unsigned int> &order, size_t position, VoxelPlane &plane)
+{
+    size_t columns = plane.us.size() - 1;
+    for (size_t cell = 0; cell < plane.coverage.size(); ++cell)
+    {
+        if (plane.coverage[cell] != 3) continue;
+        int64_t cu = plane.us[cell % columns] + plane.us[cell % columns + 1];
+        int64_t cv = plane.vs[cell / columns] + plane.vs[cell / columns + 1];
+
+        // NEAREST PLANE ON EACH SIDE WITH A FACE HERE (ONE THAT COULD NOT BE RASTERIZED COUNTS AS UNKNOWN)
+        auto backFace = [&](long long step, unsigned char back)
+        {
+            for (long long k = static_cast<long long>(position) + step; k >= 0 && k < static_cast<long long>(order.size()); k += step)
+            {
+                const VoxelPlane &other = planes[order[k]];
+                if (!other.remeshed) return false;
+                unsigned char faces = VoxelCoverageAt(other, cu, cv);
+                if (faces != 0) return (faces & back) != 0;
+            }
+            return false;
+        };
+        if (backFace(-1, 2) && backFace(1, 1)) plane.hiddenCells.push_back(cell);
+    }
+}
+
+// GREEDY MERGE PER SIDE OF THE VISIBLE CELLS: GROW ALONG U, THEN ALONG V WHILE THE WHOLE SPAN IS STILL FREE.
+// THE BOUNDARY OF EACH RECTANGLE IS SPLIT WHERE THE CELLS ACROSS IT CHANGE BETWEEN COVERED AND OPEN, SO
+// ONLY THE OPEN PARTS BECOME POLYGON EDGES AND THE SEAMS BETWEEN MERGED RECTANGLES ARE NOT DRAWN.
+void MergeVoxelPlane(VoxelPlane &plane)
+{
+    std::vector<unsigned char> &coverage = plane.coverage;
+    const std::vector<int64_t> &us = plane.us;
+    const std::vector<int64_t> &vs = plane.vs;
+    long long columns = static_cast<long long>(us.size()) - 1;
+    long long rows = static_cast<long long>(vs.size()) - 1;
+    for (size_t cell : plane.hiddenCells) coverage[cell] = 0;
+    const std::vector<unsigned char> visible = coverage;
+    for (int side = 0; side < 2; ++side)
+    {
+        unsigned char bit = static_cast<unsigned char>(1 << side);
+        auto open = [&](long long x, long long y) { return x < 0 || y < 0 || x >= columns || y >= rows || !(visible[y * columns + x] & bit); };
+        for (long long j = 0; j < rows; ++j)
+        {
+            for (long long i = 0; i < columns; ++i)
+            {
+                if (!(coverage[j * columns + i] & bit)) continue;
+                long long iEnd = i + 1;
+                while (iEnd < columns && (coverage[j * columns + iEnd] & bit)) ++iEnd;
+                long long jEnd = j + 1;
+                while (jEnd < rows)
+                {
+                    long long k = i;
+                    while (k < iEnd && (coverage[jEnd * columns + k] & bit)) ++k;
+                    if (k < iEnd) break;
+                    ++jEnd;
+                }
+                for (long long y = j; y < jEnd; ++y)
+                {
+                    for (long long x = i; x < iEnd; ++x) coverage[y * columns + x] &= static_cast<unsigned char>(~bit);
+                }
+
+                // WALK THE BOUNDARY CELL BY CELL (BOTTOM, RIGHT, TOP, LEFT), STARTING A NEW POINT ON EVERY CHANGE
+                size_t begin = plane.outline.size();
+                auto walk = [&](long long x, long long y, long long stepX, long long stepY, long long acrossX, long long acrossY, long long count, bool alongU)
+                {
+                    for (long long k = 0; k < count; ++k, x += stepX, y += stepY)
+                    {
+                        int64_t state = open(x + acrossX, y + acrossY) ? 1 : 0;
+                        if (k > 0 && state == plane.outline.back()) continue;
+                        int64_t u = alongU ? us[stepX > 0 ? x : x + 1] : us[acrossX > 0 ? x + 1 : x];
+                        int64_t v = alongU ? vs[acrossY > 0 ? y + 1 : y] : vs[stepY > 0 ? y : y + 1];
+                        plane.outline.insert(plane.outline.end(), {u, v, state});
+                    }
+                };
+                walk(i, j, 1, 0, 0, -1, iEnd - i, true);
+                walk(iEnd - 1, j, 0, 1, 1, 0, jEnd - j, false);
+                walk(iEnd - 1, jEnd - 1, -1, 0, 0, 1, iEnd - i, true);
+                walk(i, jEnd - 1, 0, -1, -1, 0, jEnd - j, false);
+                plane.rectangles.insert(plane.rectangles.end(), {us[i], vs[j], us[iEnd], vs[jEnd], side == 0 ? 1 : -1,
+                                                                  static_cast<int64_t>(begin), static_cast<int64_t>(plane.outline.size())});
+            }
+        }
+    }
+}
+
+// IMPORT TIME OPTIMIZER FOR BLOCK WORLDS: REMOVES FACES HIDDEN BETWEEN ADJACENT BLOCKS AND MERGES COPLANAR
+// AXIS ALIGNED QUADS INTO LARGER RECTANGLES. OTHER TRIANGLES (AND PLANES THAT DO NOT TILE CLEANLY) ARE KEPT
+// AS THEY ARE, SO ANY MESH CAN GO THROUGH IT. RUN BEFORE THE MESH IS CACHED, RETURNS TRUE IF IT CHANGED.
+bool OptimizeVoxelMesh(Mesh &mesh)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t triangleCount = mesh.indices.size() / 3;
+    size_t vertexCount = mesh.vertices.size() / 3;
+    glm::vec3 size = mesh.boundsMax - mesh.boundsMin;
+    float extent = std::max({size.x, size.y, size.z});
+    if (triangleCount == 0 || !(extent > 0.0f)) return false;
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        if (mesh.indices[i] >= vertexCount) return false;
+    }
+
+    // SNAP CORNERS TO THE GRID (RELATIVE TO THE BOUNDS, SO PRODUCTS STAY WELL WITHIN 64 BITS)
+    double cell = std::ldexp(1.0, static_cast<int>(std::ceil(std::log2(extent))) - VOXEL_GRID_BITS);
+    double origin[3] = {mesh.boundsMin.x, mesh.boundsMin.y, mesh.boundsMin.z};
+    auto snap = [&](size_t t, int i)
+    {
+        return std::llround((mesh.vertices[mesh.indices[t * 3 + i / 3] * 3 + i % 3] - origin[i % 3]) / cell);
+    };
+    auto snapTriangle = [&](size_t t, int64_t corners[9])
+    {
+        for (int i = 0; i < 9; ++i) corners[i] = snap(t, i);
+    };
+
+    // FIND THE AXIS ALIGNED TRIANGLES FIRST (AXIS + 1, 0 FOR THE OTHERS), A MESH WITHOUT ANY COSTS ONE PASS.
+    // THE OTHER COORDINATES ARE ONLY SNAPPED ONCE ONE AXIS MATCHES.
+    std::vector<unsigned char> remeshable(triangleCount, 0);
+    long long alignedCount = 0;
+    #pragma omp parallel for reduction(+ : alignedCount)
+    for (long long t = 0; t < static_cast<long long>(triangleCount); ++t)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            int64_t level = snap(t, axis);
+            if (level != snap(t, 3 + axis) || level != snap(t, 6 + axis)) continue;
+            int64_t corners[9];
+            snapTriangle(t, corners);
+            int u = (axis + 1) % 3;
+            int v = (axis + 2) % 3;
+            if (VoxelCross(corners[u], corners[v], corners[3 + u], corners[3 + v], corners[6 + u], corners[6 + v]) == 0) break;
+            remeshable[t] = static_cast<unsigned char>(axis + 1);
+            ++alignedCount;
+            break;
+        }
+    }
+    if (alignedCount == 0) return false;
+
+
+
+    // GROUP THEM BY PLANE (IN ORDER OF FIRST USE, SO THE OUTPUT IS DETERMINISTIC)
+    std::vector<VoxelPlane> planes;
+    std::unordered_map<uint64_t, unsigned int> planeIds;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (remeshable[t] == 0) continue;
+        int axis = remeshable[t] - 1;
+        int64_t corners[9];
+        snapTriangle(t, corners);
+        uint64_t key = static_cast<uint64_t>(axis) << 62 | static_cast<uint64_t>(corners[axis]);
+        auto found = planeIds.emplace(key, static_cast<unsigned int>(planes.size()));
+        if (found.second)
+        {
+            planes.emplace_back();
+            planes.back().axis = axis;
+            planes.back().coordinate = corners[axis];
+        }
+        VoxelPlane &plane = planes[found.first->second];
+        plane.triangles.push_back(static_cast<unsigned int>(t));
+        plane.corners.insert(plane.corners.end(), corners, corners + 9);
+        remeshable[t] = 1;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long p = 0; p < static_cast<long long>(planes.size()); ++p)
+    {
+        RasterizeVoxelPlane(planes[p]);
+    }
+
+    std::vector<unsigned int> order[3];
+    std::vector<size_t> position(planes.size());
+    for (size_t p = 0; p < planes.size(); ++p) order[planes[p].axis].push_back(static_cast<unsigned int>(p));
+    for (std::vector<unsigned int> &axisOrder : order)
+    {
+        std::sort(axisOrder.begin(), axisOrder.end(), [&](unsigned int a, unsigned int b) { return planes[a].coordinate < planes[b].coordinate; });
+        for (size_t k = 0; k < axisOrder.size(); ++k) position[axisOrder[k]] = k;
+    }
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long p = 0; p < static_cast<long long>(planes.size()); ++p)
+    {
+        if (planes[p].remeshed) FindHiddenVoxelCells(planes, order[planes[p].axis], position[p], planes[p]);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (long long p = 0; p < static_cast<long long>(planes.size()); ++p)
+    {
+        if (planes[p].remeshed) MergeVoxelPlane(planes[p]);
+    }
+    size_t remeshedPlanes = 0;
+    size_t hiddenCells = 0;
+    for (const VoxelPlane &plane : planes)
+    {
+        if (!plane.remeshed) continue;
+        ++remeshedPlanes;
+        hiddenCells += plane.hiddenCells.size();
+        for (unsigned int t : plane.triangles) remeshable[t] = 2;
+    }
+    if (remeshedPlanes == 0) return false;
+
+    // NEW VERTICES TAKE THE ORIGINAL COORDINATE THAT SNAPPED TO THEIR GRID LINE, NOT THE GRID POSITION
+    std::unordered_map<int64_t, float> coordinates[3];
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (remeshable[t] != 2) continue;
+        int64_t corners[9];
+        snapTriangle(t, corners);
+        for (int i = 0; i < 9; ++i) coordinates[i % 3].emplace(corners[i], mesh.vertices[mesh.indices[t * 3 + i / 3] * 3 + i % 3]);
+    }
+
+
+
+    // REBUILD THE MESH: KEPT TRIANGLES WITH THEIR OWN VERTICES AND EDGE MASKS, THEN TWO TRIANGLES PER
+    // RECTANGLE (THE DIAGONAL IS NOT A POLYGON EDGE), OR A FAN AROUND ITS CENTER WHEN ITS BOUNDARY IS SPLIT.
+    // BOUNDARY POINTS ARE SHARED BY GRID POSITION.
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned char> edgeMasks;
+    std::vector<unsigned int> remap(vertexCount, 0xFFFFFFFF);
+    bool hasEdgeMasks = mesh.edgeMasks.size() == triangleCount;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (remeshable[t] == 2) continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int index = mesh.indices[t * 3 + k];
+            if (remap[index] == 0xFFFFFFFF)
+            {
+                remap[index] = static_cast<unsigned int>(vertices.size() / 3);
+                vertices.insert(vertices.end(), {mesh.vertices[index * 3], mesh.vertices[index * 3 + 1], mesh.vertices[index * 3 + 2]});
+            }
+            indices.push_back(remap[index]);
+        }
+        edgeMasks.push_back(hasEdgeMasks ? mesh.edgeMasks[t] : 0x7);
+    }
+    size_t keptTriangles = edgeMasks.size();
+
+    std::unordered_map<uint64_t, unsigned int> cornerIds;
+    auto corner = [&](const int64_t position[3])
+    {
+        uint64_t key = static_cast<uint64_t>(position[0]) << 42 | static_cast<uint64_t>(position[1]) << 21 | static_cast<uint64_t>(position[2]);
+        auto found = cornerIds.emplace(key, static_cast<unsigned int>(vertices.size() / 3));
+        if (found.second)
+        {
+            for (int k = 0; k < 3; ++k) vertices.push_back(coordinates[k][position[k]]);
+        }
+        return found.first->second;
+    };
+    for (const VoxelPlane &plane : planes)
+    {
+        int u = (plane.axis + 1) % 3;
+        int v = (plane.axis + 2) % 3;
+        for (size_t r = 0; r < plane.rectangles.size(); r += 7)
+        {
+            const int64_t *rectangle = &plane.rectangles[r];
+            const int64_t *points = &plane.outline[rectangle[5]];
+            size_t pointCount = static_cast<size_t>(rectangle[6] - rectangle[5]) / 3;
+            std::vector<unsigned int> ids(pointCount);
+            for (size_t k = 0; k < pointCount; ++k)
+            {
+                int64_t position[3];
+                position[plane.axis] = plane.coordinate;
+                position[u] = points[k * 3];
+                position[v] = points[k * 3 + 1];
+                ids[k] = corner(position);
+            }
+            auto open = [&](size_t k) { return static_cast<unsigned char>(points[(k % pointCount) * 3 + 2]); };
+            if (pointCount == 4)
+            {
+                if (rectangle[4] > 0)
+                {
+                    indices.insert(indices.end(), {ids[0], ids[1], ids[2], ids[0], ids[2], ids[3]});
+                    edgeMasks.insert(edgeMasks.end(), {static_cast<unsigned char>(open(0) | open(1) << 1), static_cast<unsigned char>(open(2) << 1 | open(3) << 2)});
+                }
+                else
+                {
+                    indices.insert(indices.end(), {ids[0], ids[2], ids[1], ids[0], ids[3], ids[2]});
+                    edgeMasks.insert(edgeMasks.end(), {static_cast<unsigned char>(open(1) << 1 | open(0) << 2), static_cast<unsigned char>(open(3) | open(2) << 1)});
+                }
+                continue;
+            }
+
+            unsigned int center = static_cast<unsigned int>(vertices.size() / 3);
+            for (int k = 0; k < 3; ++k)
+            {
+                int64_t low = k == plane.axis ? plane.coordinate : k == u ? rectangle[0] : rectangle[1];
+                int64_t high = k == plane.axis ? plane.coordinate : k == u ? rectangle[2] : rectangle[3];
+                vertices.push_back((coordinates[k][low] + coordinates[k][high]) * 0.5f);
+            }
+            for (size_t k = 0; k < pointCount; ++k)
+            {
+                unsigned int next = ids[(k + 1) % pointCount];
+                if (rectangle[4] > 0) indices.insert(indices.end(), {center, ids[k], next});
+                else indices.insert(indices.end(), {center, next, ids[k]});
+                edgeMasks.push_back(static_cast<unsigned char>(open(k) << 1));
+            }
+        }
+    }
+
+    size_t remeshedTriangles = 0;
+    for (unsigned char state : remeshable) remeshedTriangles += state == 2;
+    mesh.vertices = MeshBuffer<float>(std::move(vertices));
+    mesh.indices = MeshBuffer<unsigned int>(std::move(indices));
+    mesh.edgeMasks = MeshBuffer<unsigned char>(std::move(edgeMasks));
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "[OptimizeVoxelMesh] " << triangleCount << " -> " << mesh.TriangleCount() << " triangles ("
+              << remeshedTriangles << " on " << remeshedPlanes << " axis aligned planes became "
+              << mesh.TriangleCount() - keptTriangles << ", " << hiddenCells << " hidden cells dropped) in " << milliseconds << " ms" << std::endl;
+    return true;
+}